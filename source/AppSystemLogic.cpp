@@ -13,40 +13,30 @@
 
 
 #include "AppSystemLogic.h"
+#include "Trace.h"
 #include <UnigineWorld.h>
 
 using namespace Unigine;
 
-// System logic, it exists during the application life cycle.
-// These methods are called right after corresponding system script's (UnigineScript) methods.
-
-NumberUi create_number_ui(const char *name, const WidgetGridBoxPtr &grid)
-{
-	NumberUi ui;
-
-	GuiPtr gui = grid->getGui();
-
-	auto h_box = WidgetHBox::create(gui);
-	h_box->setSpace(5, 0);
-
-	auto label = WidgetLabel::create(gui, name);
-
-	ui.edit_line = WidgetEditLine::create(gui);
+// Undo history of the last session, it is left behind only if the app crashed.
+constexpr char JOURNAL_PATH[] = "openair_bindings.journal";
 
-	ui.slider = WidgetSlider::create(gui);
-	ui.slider->setWidth(165);
+// Properties shown in the Parameters window, the paths also key the undo journal.
+constexpr auto DECAL_PROPERTIES = binds::make_property_table(
+	binds::property<&DecalOrtho::getWidth, &DecalOrtho::setWidth>("decal.width", "Width", 0.0, 5.0),
+	binds::property<&DecalOrtho::getHeight, &DecalOrtho::setHeight>("decal.height", "Height", 0.0, 5.0));
 
-	h_box->addChild(ui.edit_line);
-	h_box->addChild(ui.slider, Gui::ALIGN_EXPAND);
+#if BINDS_TRACE
+// Last seconds of binding and undo activity, written on F5, open it in chrome://tracing or Perfetto.
+constexpr char TRACE_PATH[] = "openair_bindings.trace.json";
+#endif
 
-	grid->addChild(label, Gui::ALIGN_LEFT);
-	grid->addChild(h_box, Gui::ALIGN_LEFT);
-
-	return ui;
-}
+// System logic, it exists during the application life cycle.
+// These methods are called right after corresponding system script's (UnigineScript) methods.
 
 AppSystemLogic::AppSystemLogic()
-	: binder_(undo_stack_, [this]() { return decal_.get(); })
+	: decal_("decal")
+	, binder_(undo_stack_, decal_)
 {}
 
 AppSystemLogic::~AppSystemLogic()
@@ -69,54 +59,38 @@ int AppSystemLogic::init()
 	viewport->setTitle("Viewport");
 
 	// Init parametes window
-	auto parameters= EngineWindowViewport::create("Parameters", 512, 256);
+	parameters_ = EngineWindowViewport::create("Parameters", 512, 256);
 
-	auto wrapper = WidgetScrollBox::create(parameters->getSelfGui());
+	auto wrapper = WidgetScrollBox::create(parameters_->getSelfGui());
 	wrapper->setBackground(true);
 	wrapper->setBorder(false);
 
-	auto v_box = WidgetGridBox::create(parameters->getSelfGui(), 2, 2, 2);
+	auto v_box = WidgetVBox::create(parameters_->getSelfGui(), 2, 2);
 	v_box->setBackground(true);
 	v_box->setPadding(10, 10, 10, 10);
 	v_box->setSpace(5, 5);
 
-	width_ui_ = create_number_ui("Width", v_box);
-	height_ui_ = create_number_ui("Height", v_box);
+	// the widgets are created on the first update, once the window is shown
+	decal_group_ = binds::make_property_group(binder_, parameters_->getSelfGui(), "Decal",
+		DECAL_PROPERTIES);
+	decal_group_->setExpanded(true);
+	v_box->addChild(decal_group_->getWidget(), Gui::ALIGN_EXPAND);
 
 	wrapper->addChild(v_box, Gui::ALIGN_TOP | Gui::ALIGN_LEFT);
-	parameters->addChild(wrapper, Gui::ALIGN_EXPAND);
+	parameters_->addChild(wrapper, Gui::ALIGN_EXPAND);
+
+#if BINDS_PROFILE
+	stats_overlay_ = std::make_unique<binds::StatsOverlay>(parameters_->getSelfGui());
+	parameters_->addChild(stats_overlay_->getWidget(), Gui::ALIGN_LEFT);
+#endif
 
 	// Init layouts
-	auto main = WindowManager::stackWindows(viewport, parameters,
+	auto main = WindowManager::stackWindows(viewport, parameters_,
 		EngineWindowGroup::GROUP_TYPE_HORIZONTAL);
 
-
-//	// init bindings
-//	{
-//		auto binding = binder_.create<float>(&DecalOrtho::getWidth, &DecalOrtho::setWidth);
-//		binding->attach(width_ui_.edit_line);
-//		binding->attach(width_ui_.slider);
-//	}
-
-//	{
-//		auto binding = binder_.create<float>(&DecalOrtho::getHeight, &DecalOrtho::setHeight);
-//		binding->attach(height_ui_.edit_line);
-//		binding->attach(height_ui_.slider);
-//	}
-
-	// init bonus bindings
-	{
-		auto binding = binder_.create<&DecalOrtho::getWidth, &DecalOrtho::setWidth>();
-		binding->attach(width_ui_.edit_line);
-		binding->attach(width_ui_.slider);
-	}
-
-	{
-		auto binding = binder_.create<&DecalOrtho::getHeight, &DecalOrtho::setHeight>();
-		binding->attach(height_ui_.edit_line);
-		binding->attach(height_ui_.slider);
-	}
-
+#if BINDS_TRACE
+	Trace::setEnabled(true);
+#endif
 
 	main->setTitle("Editor");
 	main->setSize({1024, 512});
@@ -134,14 +108,38 @@ int AppSystemLogic::init()
 
 int AppSystemLogic::update()
 {
-	if (decal_.isNull())
+	// the bindings are refreshed once the handle resolves to another node, e.g. after
+	// a world reload or once the decal is deleted
+	DecalOrtho *decal = decal_.get();
+	if (decal != bound_decal_ || decal_epoch_ != binds::NodeEpoch::get())
 	{
-		decal_ = static_ptr_cast<DecalOrtho>(World::getNodeByName("decal"));
-		assert(decal_.isValid());
+		bound_decal_ = decal;
+		decal_epoch_ = binds::NodeEpoch::get();
+		binder_.invalidateAll();
 	}
 
+	// replayed commands need the decal, it exists once the world is loaded
+	if (!journal_replayed_ && !decal_.isNull())
+	{
+		journal_replayed_ = true;
+		if (int num_records = journal_.replay(JOURNAL_PATH, undo_stack_, binder_))
+		{
+			Log::message("Recovered %d undo records\n", num_records);
+		}
+		if (journal_.open(JOURNAL_PATH))
+		{
+			undo_stack_.setJournal(&journal_);
+		}
+	}
+
+	decal_group_->update();
+	binder_.setHidden(parameters_->isHidden() || parameters_->isMinimized());
 	binder_.update();
 
+#if BINDS_PROFILE
+	stats_overlay_->update(binder_.getBindings());
+#endif
+
 	if (Input::isKeyPressed(Input::KEY_LEFT_CTRL) && Input::isKeyDown(Input::KEY_Z))
 	{
 		undo_stack_.undo();
@@ -152,6 +150,18 @@ int AppSystemLogic::update()
 		undo_stack_.redo();
 	}
 
+#if BINDS_TRACE
+	if (Input::isKeyDown(Input::KEY_F5))
+	{
+		if (Trace::dump(TRACE_PATH))
+		{
+			Log::message("Trace is written to %s\n", TRACE_PATH);
+		}
+	}
+#endif
+
+	journal_.update();
+
 	// Write here code to be called before updating each render frame.
 	return 1;
 }
@@ -170,6 +180,13 @@ int AppSystemLogic::postUpdate()
 int AppSystemLogic::shutdown()
 {
 	// Write here code to be called on engine shutdown.
+	undo_stack_.setJournal(nullptr);
+	journal_.discard();
+
+	decal_group_.reset();
+#if BINDS_PROFILE
+	stats_overlay_.reset();
+#endif
 	return 1;
 }
 
@@ -15,20 +15,19 @@
 #ifndef __APP_SYSTEM_LOGIC_H__
 #define __APP_SYSTEM_LOGIC_H__
 
-//#include "Bindings.h"
-#include "BonusBindings.h"
+#include "Bindings.h"
+#include "NodeHandle.h"
+#include "PropertySheet.h"
+#include "StatsOverlay.h"
 
+#include "UndoJournal.h"
 #include "UndoStack.h"
 
 #include <UnigineDecals.h>
 #include <UnigineLog.h>
 #include <UnigineLogic.h>
 
-struct NumberUi
-{
-	Unigine::WidgetEditLinePtr edit_line;
-	Unigine::WidgetSliderPtr slider;
-};
+#include <memory>
 
 class AppSystemLogic : public Unigine::SystemLogic
 {
@@ -43,13 +42,22 @@ public:
 
 	int shutdown() override;
 private:
-	Unigine::DecalOrthoPtr decal_;
-
-	NumberUi width_ui_;
-	NumberUi height_ui_;
+	binds::NodeHandle<Unigine::DecalOrtho> decal_;
+	// node and epoch the bindings were last refreshed for
+	Unigine::DecalOrtho *bound_decal_{};
+	uint32_t decal_epoch_{0};
+	Unigine::EngineWindowViewportPtr parameters_;
 
 	UndoStack undo_stack_;
-	binds::Binder<Unigine::DecalOrtho> binder_;
+	UndoJournal journal_;
+	// the journal is replayed once, even if it can't be opened for writing afterwards
+	bool journal_replayed_{false};
+	binds::Binder<Unigine::DecalOrtho, binds::NodeInstance<Unigine::DecalOrtho>> binder_;
+	std::unique_ptr<binds::PropertyGroup> decal_group_;
+
+#if BINDS_PROFILE
+	std::unique_ptr<binds::StatsOverlay> stats_overlay_;
+#endif
 };
 
 #endif // __APP_SYSTEM_LOGIC_H__
@@ -13,6 +13,7 @@
 
 
 #include "AppWorldLogic.h"
+#include "NodeHandle.h"
 
 // World logic, it takes effect only when the world is loaded.
 // These methods are called right after corresponding world script's (UnigineScript) methods.
@@ -26,6 +27,7 @@ AppWorldLogic::~AppWorldLogic()
 int AppWorldLogic::init()
 {
 	// Write here code to be called on world initialization: initialize resources for your world scene during the world start.
+	binds::NodeEpoch::advance();
 	return 1;
 }
 
@@ -60,6 +62,7 @@ int AppWorldLogic::updatePhysics()
 int AppWorldLogic::shutdown()
 {
 	// Write here code to be called on world shutdown: delete resources that were created during world script execution to avoid memory leaks.
+	binds::NodeEpoch::advance();
 	return 1;
 }
 
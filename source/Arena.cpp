@@ -0,0 +1,145 @@
+#include "Arena.h"
+
+#include <cassert>
+
+namespace
+{
+
+constexpr size_t align_size(size_t size, size_t alignment)
+{
+	return (size + alignment - 1) & ~(alignment - 1);
+}
+
+}
+
+void Arena::clear()
+{
+	lifetime_.reset();
+
+	for (int i = pools_.size() - 1; i >= 0; --i)
+	{
+		Pool *pool = pools_[i];
+		if (pool->destroy)
+		{
+			Unigine::Vector<char> is_free;
+			is_free.resize(pool->count);
+			for (int j = 0; j < pool->count; ++j)
+			{
+				is_free[j] = 0;
+			}
+			for (const auto &object : pool->free_slots)
+			{
+				is_free[pool->indexOf(object)] = 1;
+			}
+
+			for (int j = pool->count - 1; j >= 0; --j)
+			{
+				if (!is_free[j])
+				{
+					pool->destroy(pool->slot(j));
+				}
+			}
+		}
+
+		for (const auto &chunk : pool->chunks)
+		{
+			::operator delete(chunk);
+		}
+		delete pool;
+	}
+
+	pools_.clear();
+	last_pool_ = nullptr;
+}
+
+std::weak_ptr<void> Arena::getLifetime()
+{
+	if (!lifetime_)
+	{
+		lifetime_ = std::make_shared<char>(0);
+	}
+	return lifetime_;
+}
+
+int Arena::getNumObjects() const
+{
+	int count = 0;
+	for (const auto &pool : pools_)
+	{
+		count += pool->count - pool->free_slots.size();
+	}
+	return count;
+}
+
+size_t Arena::getReservedMemory() const
+{
+	size_t size = 0;
+	for (const auto &pool : pools_)
+	{
+		size += pool->chunks.size() * pool->chunk_capacity * pool->stride;
+	}
+	return size;
+}
+
+void *Arena::Pool::allocate()
+{
+	if (free_slots.empty())
+	{
+		return slot(count++);
+	}
+
+	void *object = free_slots.last();
+	free_slots.removeAt(free_slots.size() - 1);
+	return object;
+}
+
+void *Arena::Pool::slot(int index)
+{
+	const int chunk = index / chunk_capacity;
+	if (chunk == chunks.size())
+	{
+		chunks.append(static_cast<char *>(::operator new(chunk_capacity * stride)));
+	}
+	return chunks[chunk] + (index % chunk_capacity) * stride;
+}
+
+int Arena::Pool::indexOf(const void *object) const
+{
+	const char *ptr = static_cast<const char *>(object);
+	for (int i = 0; i < chunks.size(); ++i)
+	{
+		if (ptr >= chunks[i] && ptr < chunks[i] + chunk_capacity * stride)
+		{
+			return i * chunk_capacity + static_cast<int>((ptr - chunks[i]) / stride);
+		}
+	}
+
+	assert(false); // or log error/fatal
+	return -1;
+}
+
+Arena::Pool &Arena::getPool(const void *type, size_t size, size_t alignment, Destroy destroy)
+{
+	if (last_pool_ && last_pool_->type == type)
+	{
+		return *last_pool_;
+	}
+
+	for (const auto &pool : pools_)
+	{
+		if (pool->type == type)
+		{
+			last_pool_ = pool;
+			return *pool;
+		}
+	}
+
+	auto pool = new Pool();
+	pool->type = type;
+	pool->destroy = destroy;
+	pool->stride = align_size(size, alignment);
+	pool->chunk_capacity = static_cast<int>(pool->stride < CHUNK_SIZE ? CHUNK_SIZE / pool->stride : 1);
+	pools_.append(pool);
+	last_pool_ = pool;
+	return *pool;
+}
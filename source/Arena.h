@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Common.h"
+
+#include <UnigineVector.h>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Bump storage grouped by type: objects of one type are packed into chunks of their
+// own, so walking them touches memory in order. clear() destroys everything at once,
+// the newest type and object first. Memory is released only then, the slot of an
+// object destroyed earlier is reused by the next object of its type.
+class Arena final
+{
+public:
+	Arena() = default;
+	~Arena() { clear(); }
+
+	Arena(const Arena &) = delete;
+	Arena &operator=(const Arena &) = delete;
+
+	template<typename T, typename... Args>
+	T *create(Args &&...args)
+	{
+		static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+
+		Pool &pool = getPool(type_tag<T>(), sizeof(T), alignof(T),
+			std::is_trivially_destructible_v<T> ? nullptr : &destroyObject<T>);
+		return new (pool.allocate()) T(std::forward<Args>(args)...);
+	}
+
+	template<typename T>
+	void destroy(T *object)
+	{
+		Pool &pool = getPool(type_tag<T>(), sizeof(T), alignof(T),
+			std::is_trivially_destructible_v<T> ? nullptr : &destroyObject<T>);
+		object->~T();
+		pool.free_slots.append(object);
+	}
+
+	void clear();
+
+	// Expires when clear() or the destructor destroys the objects, see ArenaHandle.
+	std::weak_ptr<void> getLifetime();
+
+	int getNumObjects() const;
+	size_t getReservedMemory() const;
+
+private:
+	static constexpr size_t CHUNK_SIZE = 16 * 1024;
+
+	using Destroy = void (*)(void *);
+
+	template<typename T>
+	static void destroyObject(void *object)
+	{
+		static_cast<T *>(object)->~T();
+	}
+
+	struct Pool
+	{
+		const void *type{};
+		Destroy destroy{};
+		size_t stride{0};
+		int chunk_capacity{0};
+		// slots ever used, including the free ones
+		int count{0};
+		Unigine::Vector<char *> chunks;
+		Unigine::Vector<void *> free_slots;
+
+		void *allocate();
+		// allocates the chunk of the slot if it does not exist yet
+		void *slot(int index);
+		int indexOf(const void *object) const;
+	};
+
+	Pool &getPool(const void *type, size_t size, size_t alignment, Destroy destroy);
+
+	Unigine::Vector<Pool *> pools_;
+	// the last pool used, consecutive creates are usually of the same type
+	Pool *last_pool_{};
+	// made on demand, most arenas are never asked for handles
+	std::shared_ptr<char> lifetime_;
+};
+
+// Pointer to an arena object for holders that may outlive the arena, e.g. undo
+// commands. get() is nullptr once the arena is cleared or destroyed. Objects
+// destroyed one by one must not be referred to by handles.
+template<typename T>
+class ArenaHandle
+{
+public:
+	ArenaHandle() = default;
+	ArenaHandle(T *object, Arena &arena)
+		: object_(object)
+		, lifetime_(arena.getLifetime())
+	{}
+
+	T *get() const { return lifetime_.expired() ? nullptr : object_; }
+
+private:
+	T *object_{};
+	std::weak_ptr<void> lifetime_;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Define BINDS_PROFILE=1 to collect per-binding counters, with 0 the counting
+// macros expand to nothing and bindings carry no stats.
+#ifndef BINDS_PROFILE
+#define BINDS_PROFILE 0
+#endif
+
+namespace binds
+{
+
+struct BindingStats
+{
+	uint64_t num_gets{0};
+	uint64_t num_sets{0};
+	uint64_t num_widget_writes{0};
+	// widget writes skipped because compare() found the displayed value unchanged
+	uint64_t num_skipped_writes{0};
+	// spent in writes, fetches and views refreshes
+	int64_t time_ns{0};
+
+	BindingStats &operator+=(const BindingStats &other)
+	{
+		num_gets += other.num_gets;
+		num_sets += other.num_sets;
+		num_widget_writes += other.num_widget_writes;
+		num_skipped_writes += other.num_skipped_writes;
+		time_ns += other.time_ns;
+		return *this;
+	}
+};
+
+#if BINDS_PROFILE
+
+class StatsTimer final
+{
+public:
+	explicit StatsTimer(BindingStats &stats)
+		: stats_(stats)
+		, start_(std::chrono::steady_clock::now())
+	{}
+
+	~StatsTimer()
+	{
+		using namespace std::chrono;
+		stats_.time_ns += duration_cast<nanoseconds>(steady_clock::now() - start_).count();
+	}
+
+	StatsTimer(const StatsTimer &) = delete;
+	StatsTimer &operator=(const StatsTimer &) = delete;
+
+private:
+	BindingStats &stats_;
+	std::chrono::steady_clock::time_point start_;
+};
+
+#define BINDS_STATS_ADD(binding, counter, n) ((binding)->getStats().counter += (n))
+#define BINDS_STATS_COUNT(binding, counter) BINDS_STATS_ADD(binding, counter, 1)
+#define BINDS_STATS_TIME(binding) binds::StatsTimer binds_stats_timer_((binding)->getStats())
+
+#else
+
+#define BINDS_STATS_ADD(binding, counter, n) ((void)0)
+#define BINDS_STATS_COUNT(binding, counter) ((void)0)
+#define BINDS_STATS_TIME(binding) ((void)0)
+
+#endif
+
+}
@@ -0,0 +1,617 @@
+#pragma once
+
+#include "BindingStats.h"
+#include "Common.h"
+#include "ValueTraits.h"
+
+#include <UnigineVector.h>
+#include <UnigineWidgets.h>
+
+#include <algorithm>
+#include <climits>
+#include <unordered_map>
+
+namespace binds
+{
+
+// A widget is visible when neither it nor any ancestor is hidden and it overlaps every
+// laid out ancestor, the latter clips rows scrolled out of a scroll box.
+inline bool is_widget_visible(const Unigine::WidgetPtr &widget)
+{
+	if (!widget || widget->isHidden())
+	{
+		return false;
+	}
+
+	const int x0 = widget->getScreenPositionX();
+	const int y0 = widget->getScreenPositionY();
+	const int x1 = x0 + widget->getWidth();
+	const int y1 = y0 + widget->getHeight();
+
+	for (Unigine::WidgetPtr parent = widget->getParent(); parent; parent = parent->getParent())
+	{
+		if (parent->isHidden())
+		{
+			return false;
+		}
+
+		if (parent->getWidth() == 0 || parent->getHeight() == 0)
+		{
+			continue;
+		}
+
+		const int px0 = parent->getScreenPositionX();
+		const int py0 = parent->getScreenPositionY();
+		if (x1 <= px0 || y1 <= py0 || x0 >= px0 + parent->getWidth() || y0 >= py0 + parent->getHeight())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// True if the widget is the container or one of its descendants.
+inline bool is_widget_inside(Unigine::WidgetPtr widget, const Unigine::WidgetPtr &container)
+{
+	for (; widget; widget = widget->getParent())
+	{
+		if (widget.get() == container.get())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Visibility of widgets within one UpdateQueue pass. The clip rectangle of a
+// container is the intersection of its laid out ancestors, it's computed once
+// and shared by the widgets inside, e.g. the rows of a table.
+class VisibilityCache
+{
+public:
+	// forgets the layout of the previous pass
+	void clear() { clips_.clear(); }
+
+	// same as is_widget_visible() for the widgets of the pass
+	bool isVisible(const Unigine::WidgetPtr &widget)
+	{
+		if (!widget || widget->isHidden())
+		{
+			return false;
+		}
+
+		const Clip clip = getClip(widget->getParent());
+		const int x0 = widget->getScreenPositionX();
+		const int y0 = widget->getScreenPositionY();
+		return clip.visible && x0 + widget->getWidth() > clip.x0
+			&& y0 + widget->getHeight() > clip.y0 && x0 < clip.x1 && y0 < clip.y1;
+	}
+
+private:
+	struct Clip
+	{
+		bool visible;
+		int x0, y0, x1, y1;
+	};
+
+	Clip getClip(const Unigine::WidgetPtr &container)
+	{
+		if (!container)
+		{
+			return Clip{true, INT_MIN, INT_MIN, INT_MAX, INT_MAX};
+		}
+
+		auto it = clips_.find(container.get());
+		if (it != clips_.end())
+		{
+			return it->second;
+		}
+
+		Clip clip = getClip(container->getParent());
+		if (container->isHidden())
+		{
+			clip.visible = false;
+		}
+		else if (clip.visible && container->getWidth() != 0 && container->getHeight() != 0)
+		{
+			const int x0 = container->getScreenPositionX();
+			const int y0 = container->getScreenPositionY();
+			clip.x0 = std::max(clip.x0, x0);
+			clip.y0 = std::max(clip.y0, y0);
+			clip.x1 = std::min(clip.x1, x0 + container->getWidth());
+			clip.y1 = std::min(clip.y1, y0 + container->getHeight());
+			clip.visible = clip.x0 < clip.x1 && clip.y0 < clip.y1;
+		}
+
+		clips_.emplace(container.get(), clip);
+		return clip;
+	}
+
+	std::unordered_map<const Unigine::Widget *, Clip> clips_;
+};
+
+class IView
+{
+public:
+	virtual ~IView() = default;
+	virtual void update() = 0;
+	virtual bool isVisible(VisibilityCache &cache) const = 0;
+	// true if a widget of the view is the given one or inside it
+	virtual bool isInside(const Unigine::WidgetPtr &w) const = 0;
+
+protected:
+	IView() = default;
+};
+
+template<typename BindingT>
+class WidgetEditLineView final : public IView
+{
+public:
+	using T = typename BindingT::Value;
+
+	WidgetEditLineView(Unigine::WidgetEditLinePtr w, BindingT *b)
+		: w_(w)
+		, b_(b)
+	{
+
+		Unigine::CallbackBase *cb = Unigine::MakeCallback([this]() {
+			b_->startUpdating();
+		});
+
+		start_edit_callback_ = w_->addCallback(Unigine::Gui::FOCUS_IN, cb);
+
+		cb = Unigine::MakeCallback([this]() { w_->removeFocus(); });
+
+		pressed_callback_ = w_->addCallback(Unigine::Gui::PRESSED, cb);
+
+		cb = Unigine::MakeCallback([this]() {
+			b_->finishUpdating();
+			// text that didn't parse is replaced with the bound value
+			has_value_ = false;
+			b_->invalidate();
+		});
+
+		finish_edit_callback_ = w_->addCallback(Unigine::Gui::FOCUS_OUT, cb);
+
+		cb = Unigine::MakeCallback([this]() {
+			double valued = 0.0;
+			if (!parse_number(w_->getText(), valued))
+			{
+				return;
+			}
+
+			value_ = static_cast<T>(valued);
+			has_value_ = true;
+			b_->set(value_);
+		});
+
+		changed_callback_ = w_->addCallback(Unigine::Gui::CHANGED, cb);
+	}
+
+	~WidgetEditLineView() override
+	{
+		if (w_)
+		{
+			w_->removeCallback(Unigine::Gui::FOCUS_IN, start_edit_callback_);
+			w_->removeCallback(Unigine::Gui::FOCUS_OUT, finish_edit_callback_);
+			w_->removeCallback(Unigine::Gui::PRESSED, pressed_callback_);
+			w_->removeCallback(Unigine::Gui::CHANGED, changed_callback_);
+		}
+	}
+
+	void update() override
+	{
+		if (w_.isNull() || w_->isFocused())
+		{
+			return;
+		}
+
+		if (b_->isMixed())
+		{
+			// also clears text left by an edit that didn't parse
+			if (has_value_ || *w_->getText())
+			{
+				BINDS_STATS_COUNT(b_, num_widget_writes);
+				w_->setCallbackEnabled(Unigine::Gui::CHANGED, false);
+				w_->setText("");
+				w_->setCallbackEnabled(Unigine::Gui::CHANGED, true);
+				has_value_ = false;
+			}
+			return;
+		}
+
+		const T value = b_->get();
+
+		if (has_value_ && compare(value_, value))
+		{
+			BINDS_STATS_COUNT(b_, num_skipped_writes);
+			return;
+		}
+
+		char text[64];
+		format_number(text, sizeof(text), value, std::is_integral_v<T> ? 0 : b_->getPrecision());
+
+		BINDS_STATS_COUNT(b_, num_widget_writes);
+		w_->setCallbackEnabled(Unigine::Gui::CHANGED, false);
+		w_->setText(text);
+		w_->setCallbackEnabled(Unigine::Gui::CHANGED, true);
+
+		value_ = value;
+		has_value_ = true;
+	}
+
+	bool isVisible(VisibilityCache &cache) const override { return cache.isVisible(w_); }
+	bool isInside(const Unigine::WidgetPtr &w) const override { return is_widget_inside(w_, w); }
+
+private:
+	void *start_edit_callback_{};
+	void *pressed_callback_{};
+	void *finish_edit_callback_{};
+	void *changed_callback_{};
+
+	// last displayed or typed value, saves parsing the widget text on every update
+	T value_{};
+	bool has_value_{false};
+
+	Unigine::WidgetEditLinePtr w_;
+	BindingT *b_{};
+};
+
+template<typename BindingT>
+class SliderView final : public IView
+{
+public:
+	using T = typename BindingT::Value;
+
+	SliderView(Unigine::WidgetSliderPtr w, BindingT *b)
+		: w_(w)
+		, b_(b)
+	{
+		Unigine::CallbackBase *cb = Unigine::MakeCallback([this]() {
+			b_->startUpdating();
+			is_editing_ = true;
+		});
+
+		start_edit_callback_ = w_->addCallback(Unigine::Gui::PRESSED, cb);
+
+		cb = Unigine::MakeCallback([this]() {
+			b_->finishUpdating();
+			is_editing_ = false;
+		});
+
+		finish_edit_callback_ = w_->addCallback(Unigine::Gui::RELEASED, cb);
+
+		cb = Unigine::MakeCallback([this]() {
+			b_->set(static_cast<T>(
+				remap(w_->getMinValue(), w_->getMaxValue(), b_->getMinValue(), b_->getMaxValue(),
+					w_->getValue())));
+		});
+
+		changed_callback_ = w_->addCallback(Unigine::Gui::CHANGED, cb);
+	}
+
+	~SliderView() override
+	{
+		if (w_)
+		{
+			w_->removeCallback(Unigine::Gui::PRESSED, start_edit_callback_);
+			w_->removeCallback(Unigine::Gui::RELEASED, finish_edit_callback_);
+			w_->removeCallback(Unigine::Gui::CHANGED, changed_callback_);
+		}
+	}
+
+	void update() override
+	{
+		if (is_editing_)
+		{
+			return;
+		}
+
+		const T value = b_->get();
+
+		BINDS_STATS_COUNT(b_, num_widget_writes);
+		w_->setCallbackEnabled(Unigine::Gui::CHANGED, false);
+		w_->setValue(remap(b_->getMinValue(), b_->getMaxValue(), w_->getMinValue(), w_->getMaxValue(),
+			value));
+		w_->setCallbackEnabled(Unigine::Gui::CHANGED, true);
+	}
+
+	bool isVisible(VisibilityCache &cache) const override { return cache.isVisible(w_); }
+	bool isInside(const Unigine::WidgetPtr &w) const override { return is_widget_inside(w_, w); }
+
+private:
+	double remap(double in_min, double in_max, double out_min, double out_max, double in_v)
+	{
+		using namespace Unigine::Math;
+		return lerp(out_min, out_max, inverseLerp(in_min, in_max, in_v));
+	}
+
+	void *start_edit_callback_{};
+	void *finish_edit_callback_{};
+	void *changed_callback_{};
+
+	bool is_editing_{false};
+	Unigine::WidgetSliderPtr w_;
+	BindingT *b_{};
+};
+
+// One edit line per component, only the components that changed are written.
+template<typename BindingT>
+class MultiEditLineView final : public IView
+{
+public:
+	using T = typename BindingT::Value;
+	using Traits = ValueTraits<T>;
+	using Component = typename Traits::Component;
+
+	MultiEditLineView(const Unigine::Vector<Unigine::WidgetEditLinePtr> &w, BindingT *b)
+		: b_(b)
+	{
+		assert(w.size() == Traits::size);
+
+		for (int i = 0; i < Traits::size; ++i)
+		{
+			Field &field = fields_[i];
+			field.w = w[i];
+
+			Unigine::CallbackBase *cb = Unigine::MakeCallback([this]() {
+				b_->startUpdating();
+			});
+
+			field.start_edit_callback = field.w->addCallback(Unigine::Gui::FOCUS_IN, cb);
+
+			cb = Unigine::MakeCallback([this, i]() { fields_[i].w->removeFocus(); });
+
+			field.pressed_callback = field.w->addCallback(Unigine::Gui::PRESSED, cb);
+
+			cb = Unigine::MakeCallback([this, i]() {
+				b_->finishUpdating();
+				// text that didn't parse is replaced with the bound value
+				fields_[i].has_value = false;
+				b_->invalidate();
+			});
+
+			field.finish_edit_callback = field.w->addCallback(Unigine::Gui::FOCUS_OUT, cb);
+
+			cb = Unigine::MakeCallback([this, i]() {
+				Field &field = fields_[i];
+
+				double valued = 0.0;
+				if (!parse_number(field.w->getText(), valued))
+				{
+					return;
+				}
+
+				field.value = static_cast<Component>(valued);
+				field.has_value = true;
+
+				b_->setComponent(i, field.value);
+			});
+
+			field.changed_callback = field.w->addCallback(Unigine::Gui::CHANGED, cb);
+		}
+	}
+
+	~MultiEditLineView() override
+	{
+		for (const Field &field : fields_)
+		{
+			if (field.w)
+			{
+				field.w->removeCallback(Unigine::Gui::FOCUS_IN, field.start_edit_callback);
+				field.w->removeCallback(Unigine::Gui::FOCUS_OUT, field.finish_edit_callback);
+				field.w->removeCallback(Unigine::Gui::PRESSED, field.pressed_callback);
+				field.w->removeCallback(Unigine::Gui::CHANGED, field.changed_callback);
+			}
+		}
+	}
+
+	void update() override
+	{
+		if (b_->isMixed())
+		{
+			for (Field &field : fields_)
+			{
+				if ((field.has_value || *field.w->getText()) && !field.w->isFocused())
+				{
+					BINDS_STATS_COUNT(b_, num_widget_writes);
+					setText(field, "");
+					field.has_value = false;
+				}
+			}
+			return;
+		}
+
+		const T value = b_->get();
+		const int precision = std::is_integral_v<Component> ? 0 : b_->getPrecision();
+
+		for (int i = 0; i < Traits::size; ++i)
+		{
+			Field &field = fields_[i];
+			const Component component = Traits::get(value, i);
+
+			if (field.w->isFocused())
+			{
+				continue;
+			}
+
+			if (field.has_value && compare(field.value, component))
+			{
+				BINDS_STATS_COUNT(b_, num_skipped_writes);
+				continue;
+			}
+
+			char text[64];
+			format_number(text, sizeof(text), component, precision);
+			BINDS_STATS_COUNT(b_, num_widget_writes);
+			setText(field, text);
+
+			field.value = component;
+			field.has_value = true;
+		}
+	}
+
+	bool isVisible(VisibilityCache &cache) const override
+	{
+		for (const auto &field : fields_)
+		{
+			if (cache.isVisible(field.w))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool isInside(const Unigine::WidgetPtr &w) const override
+	{
+		for (const auto &field : fields_)
+		{
+			if (is_widget_inside(field.w, w))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+private:
+	struct Field
+	{
+		Unigine::WidgetEditLinePtr w;
+
+		void *start_edit_callback{};
+		void *pressed_callback{};
+		void *finish_edit_callback{};
+		void *changed_callback{};
+
+		Component value{};
+		bool has_value{false};
+	};
+
+	static void setText(Field &field, const char *text)
+	{
+		field.w->setCallbackEnabled(Unigine::Gui::CHANGED, false);
+		field.w->setText(text);
+		field.w->setCallbackEnabled(Unigine::Gui::CHANGED, true);
+	}
+
+	Field fields_[Traits::size];
+	BindingT *b_{};
+};
+
+template<typename BindingT>
+class CheckBoxView final : public IView
+{
+public:
+	using T = typename BindingT::Value;
+
+	CheckBoxView(Unigine::WidgetCheckBoxPtr w, BindingT *b)
+		: w_(w)
+		, b_(b)
+	{
+		Unigine::CallbackBase *cb = Unigine::MakeCallback([this]() {
+			value_ = w_->isChecked();
+			has_value_ = true;
+			b_->set(value_);
+		});
+
+		changed_callback_ = w_->addCallback(Unigine::Gui::CHANGED, cb);
+	}
+
+	~CheckBoxView() override
+	{
+		if (w_)
+		{
+			w_->removeCallback(Unigine::Gui::CHANGED, changed_callback_);
+		}
+	}
+
+	void update() override
+	{
+		const bool value = b_->get();
+
+		if (has_value_ && value_ == value)
+		{
+			BINDS_STATS_COUNT(b_, num_skipped_writes);
+			return;
+		}
+
+		BINDS_STATS_COUNT(b_, num_widget_writes);
+		w_->setCallbackEnabled(Unigine::Gui::CHANGED, false);
+		w_->setChecked(value);
+		w_->setCallbackEnabled(Unigine::Gui::CHANGED, true);
+
+		value_ = value;
+		has_value_ = true;
+	}
+
+	bool isVisible(VisibilityCache &cache) const override { return cache.isVisible(w_); }
+	bool isInside(const Unigine::WidgetPtr &w) const override { return is_widget_inside(w_, w); }
+
+private:
+	void *changed_callback_{};
+
+	bool value_{false};
+	bool has_value_{false};
+	Unigine::WidgetCheckBoxPtr w_;
+	BindingT *b_{};
+};
+
+// Maps an integer or enum value to the item with the same index.
+template<typename BindingT>
+class ComboBoxView final : public IView
+{
+public:
+	using T = typename BindingT::Value;
+
+	ComboBoxView(Unigine::WidgetComboBoxPtr w, BindingT *b)
+		: w_(w)
+		, b_(b)
+	{
+		Unigine::CallbackBase *cb = Unigine::MakeCallback([this]() {
+			item_ = w_->getCurrentItem();
+			b_->set(static_cast<T>(item_));
+		});
+
+		changed_callback_ = w_->addCallback(Unigine::Gui::CHANGED, cb);
+	}
+
+	~ComboBoxView() override
+	{
+		if (w_)
+		{
+			w_->removeCallback(Unigine::Gui::CHANGED, changed_callback_);
+		}
+	}
+
+	void update() override
+	{
+		const int item = b_->isMixed() ? -1 : static_cast<int>(b_->get());
+
+		if (item_ == item)
+		{
+			BINDS_STATS_COUNT(b_, num_skipped_writes);
+			return;
+		}
+
+		BINDS_STATS_COUNT(b_, num_widget_writes);
+		w_->setCallbackEnabled(Unigine::Gui::CHANGED, false);
+		w_->setCurrentItem(item);
+		w_->setCallbackEnabled(Unigine::Gui::CHANGED, true);
+
+		item_ = item;
+	}
+
+	bool isVisible(VisibilityCache &cache) const override { return cache.isVisible(w_); }
+	bool isInside(const Unigine::WidgetPtr &w) const override { return is_widget_inside(w_, w); }
+
+private:
+	void *changed_callback_{};
+
+	int item_{-2};
+	Unigine::WidgetComboBoxPtr w_;
+	BindingT *b_{};
+};
+
+}
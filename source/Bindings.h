@@ -1,313 +1,775 @@
 #pragma once
 
+#include "Arena.h"
+#include "BindingStats.h"
+#include "BindingViews.h"
 #include "Common.h"
+#include "FunctionTraits.h"
+#include "SharedValue.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include "UndoJournal.h"
 #include "UndoStack.h"
+#include "ValueTraits.h"
 
+#include <UnigineLog.h>
 #include <UnigineWidgets.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+
 namespace binds
 {
 
+class PendingWrite;
+class UpdateQueue;
+class WriteQueue;
+
 class IBinding
 {
 public:
 	virtual ~IBinding() = default;
 	virtual void update() = 0;
 	virtual IBinding *attach(Unigine::WidgetPtr widget) = 0;
-};
-
-template<typename T>
-class IModel
-{
-public:
-	virtual ~IModel() = default;
-	virtual T get() const = 0;
-	virtual bool set(const T &) = 0;
-
-	virtual void startUpdating() = 0;
-	virtual void finishUpdating() = 0;
-	virtual void cancelUpdating() = 0;
-	virtual bool isUpdating() const = 0;
-};
-
-class IView
-{
-public:
-	virtual ~IView() = default;
-	virtual void update() = 0;
+	// Destroys the views of the widget and of the widgets inside it.
+	virtual void detach(const Unigine::WidgetPtr &widget) = 0;
+
+	// Rebuilds a journaled command of this binding, see UndoJournal.
+	virtual UndoCommand *read(UndoReader &reader) = 0;
+
+	// Undo commands refer to the binding through a handle, they outlive it once
+	// the binder is cleared or destroyed.
+	virtual ArenaHandle<IBinding> getHandle() = 0;
+
+	// Type-erased access for lookups by path, values must be of the type
+	// getValueType() names, see Binder::set().
+	virtual const void *getType() const = 0;
+	virtual const void *getValueType() const = 0;
+	virtual void setValue(const void *value) = 0;
+	virtual void getValue(void *value) const = 0;
+
+	// Reads the value ahead of update() on a worker thread, only called for
+	// bindings with a thread-safe getter, see ConcurrentGet. prepareFetch() runs
+	// on the main thread first, sources that look instances up resolve them there.
+	virtual void prepareFetch() {}
+	virtual void fetch() {}
+	bool isConcurrent() const { return concurrent_; }
+
+	// True if any attached view is on screen, the others are refreshed within
+	// the off-screen budget of UpdateQueue.
+	virtual bool isVisible(VisibilityCache &cache) const = 0;
+
+	// Named bindings are journaled under the hash of their name.
+	void setName(const char *name)
+	{
+		name_ = name;
+		name_hash_ = *name ? hash_string(name) : 0;
+	}
+	const char *getName() const { return name_.get(); }
+	uint32_t getNameHash() const { return name_hash_; }
+
+	// Schedules a views refresh on the next UpdateQueue::update().
+	// Models call it on every write, external writers must call it themselves.
+	void invalidate();
+	bool isDirty() const { return dirty_; }
+
+	// Polled bindings are refreshed every frame or at their refresh rate, use it
+	// for properties that can change behind the model's back.
+	void setPolling(bool enabled);
+	bool isPolling() const { return polling_; }
+
+#if BINDS_PROFILE
+	BindingStats &getStats() { return stats_; }
+	const BindingStats &getStats() const { return stats_; }
+	void resetStats() { stats_ = BindingStats{}; }
+#endif
+
+	// Polling rate in refreshes per second, 0 polls every frame.
+	void setRefreshRate(float rate)
+	{
+		refresh_interval_ = rate > 0.0f ? static_cast<int64_t>(1000000.0f / rate) : 0;
+		next_refresh_ = 0;
+	}
+	float getRefreshRate() const
+	{
+		return refresh_interval_ > 0 ? 1000000.0f / static_cast<float>(refresh_interval_) : 0.0f;
+	}
 
 protected:
-	IView() = default;
+	bool concurrent_{false};
+	// the fetched value is valid until update() or the next write
+	bool fetched_{false};
+
+private:
+	friend class UpdateQueue;
+	friend class WriteQueue;
+
+	Unigine::String name_;
+	uint32_t name_hash_{0};
+
+	UpdateQueue *queue_{};
+	bool dirty_{false};
+	bool polling_{false};
+	// microseconds
+	int64_t refresh_interval_{0};
+	int64_t next_refresh_{0};
+	// latest write found for this binding while WriteQueue::apply() coalesces, main thread only
+	PendingWrite *pending_write_{};
+
+#if BINDS_PROFILE
+	BindingStats stats_;
+#endif
 };
 
-template<typename T>
-class BindingTemplate : public IBinding
+class UpdateQueue
 {
 public:
-	using Model = IModel<T>;
+	void add(IBinding *binding)
+	{
+		assert(binding->queue_ == nullptr);
+		binding->queue_ = this;
+		binding->dirty_ = false;
+		invalidate(binding);
+	}
 
-	BindingTemplate(Model *model)
-		: model_(model)
-	{}
+	void invalidate(IBinding *binding)
+	{
+		if (binding->dirty_)
+		{
+			return;
+		}
 
-	~BindingTemplate() override { delete model_; }
+		binding->dirty_ = true;
+		dirty_.append(binding);
+	}
 
-	virtual T get() const { return model_->get(); }
-	virtual void set(const T &v)
+	void setPolling(IBinding *binding, bool enabled)
 	{
-		if (model_->set(v))
+		if (binding->polling_ == enabled)
+		{
+			return;
+		}
+
+		binding->polling_ = enabled;
+		if (enabled)
+		{
+			polled_.append(binding);
+		}
+		else
 		{
-			update();
+			polled_.removeAt(polled_.findIndex(binding));
 		}
 	}
 
-	void update() override
+	// Visible dirty bindings are refreshed right away, with a pool the getters of
+	// thread-safe ones are evaluated in parallel first. Off-screen dirty bindings
+	// are refreshed round-robin until the off-screen budget of the frame is spent.
+	void update(ThreadPool *pool = nullptr)
 	{
-		for (const auto &view : views_)
+		const int64_t now = getTime();
+		for (const auto &binding : polled_)
+		{
+			if (binding->refresh_interval_ == 0 || now >= binding->next_refresh_)
+			{
+				binding->next_refresh_ = now + binding->refresh_interval_;
+				invalidate(binding);
+			}
+		}
+
+		sortVisible();
+
+		if (pool)
+		{
+			fetch(*pool);
+		}
+
+		// bindings invalidated by views during the refresh are picked up in the same pass
+		for (int i = 0; i < dirty_.size(); ++i)
 		{
-			view->update();
+			refresh(dirty_[i]);
 		}
+		dirty_.clear();
+
+		updateOffscreen(now);
 	}
 
-	void startUpdating()
+	// Time in microseconds off-screen bindings may take per frame, 0 stops refreshing them.
+	void setOffscreenBudget(int64_t budget) { offscreen_budget_ = budget; }
+	int64_t getOffscreenBudget() const { return offscreen_budget_; }
+
+	// Treats every binding as off-screen, e.g. while the window with the views is hidden.
+	void setHidden(bool hidden) { hidden_ = hidden; }
+	bool isHidden() const { return hidden_; }
+
+	// forgets all bindings, they are about to be destroyed
+	void clear()
+	{
+		dirty_.clear();
+		polled_.clear();
+		offscreen_.clear();
+	}
+
+private:
+	// below this many bindings the fork-join costs more than it saves
+	static constexpr int MIN_PARALLEL_FETCH = 64;
+	static constexpr int FETCH_GRAIN = 16;
+
+	static int64_t getTime()
+	{
+		using namespace std::chrono;
+		return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+	}
+
+	static void refresh(IBinding *binding)
+	{
+		BINDS_STATS_TIME(binding);
+		binding->dirty_ = false;
+		binding->update();
+	}
+
+	bool isVisible(const IBinding *binding) { return !hidden_ && binding->isVisible(visibility_); }
+
+	// Moves dirty bindings that went off-screen to the off-screen list and back.
+	// Off-screen bindings stay dirty, so invalidating them again is a no-op.
+	void sortVisible()
 	{
-		if (!model_->isUpdating())
+		visibility_.clear();
+
+		int num_visible = 0;
+		for (int i = 0; i < dirty_.size(); ++i)
+		{
+			IBinding *binding = dirty_[i];
+			if (isVisible(binding))
+			{
+				dirty_[num_visible++] = binding;
+			}
+			else
+			{
+				offscreen_.append(binding);
+			}
+		}
+		dirty_.resize(num_visible);
+
+		int num_offscreen = 0;
+		for (int i = 0; i < offscreen_.size(); ++i)
 		{
-			model_->startUpdating();
+			IBinding *binding = offscreen_[i];
+			if (isVisible(binding))
+			{
+				dirty_.append(binding);
+			}
+			else
+			{
+				offscreen_[num_offscreen++] = binding;
+			}
 		}
+		offscreen_.resize(num_offscreen);
 	}
-	void finishUpdating()
+
+	// Refreshes the oldest off-screen bindings first, at least one per frame.
+	void updateOffscreen(int64_t start)
 	{
-		if (model_->isUpdating())
+		if (offscreen_budget_ <= 0 || offscreen_.empty())
 		{
-			model_->finishUpdating();
+			return;
+		}
+
+		int num_refreshed = 0;
+		do
+		{
+			refresh(offscreen_[num_refreshed++]);
+		} while (num_refreshed < offscreen_.size() && getTime() - start < offscreen_budget_);
+
+		const int size = offscreen_.size();
+		for (int i = num_refreshed; i < size; ++i)
+		{
+			offscreen_[i - num_refreshed] = offscreen_[i];
 		}
+		offscreen_.resize(size - num_refreshed);
 	}
-	void cancelUpdating()
+
+	void fetch(ThreadPool &pool)
 	{
-		if (model_->isUpdating())
+		for (const auto &binding : dirty_)
 		{
-			model_->cancelUpdating();
+			if (binding->concurrent_)
+			{
+				fetched_.append(binding);
+			}
 		}
+
+		if (fetched_.size() >= MIN_PARALLEL_FETCH)
+		{
+			TRACE_SCOPE("UpdateQueue::fetch");
+			for (const auto &binding : fetched_)
+			{
+				binding->prepareFetch();
+			}
+			pool.parallelFor(fetched_.size(), FETCH_GRAIN, [this](int begin, int end) {
+				for (int i = begin; i < end; ++i)
+				{
+					fetched_[i]->fetch();
+				}
+			});
+		}
+		fetched_.clear();
 	}
-	bool isUpdating() const { return model_->isUpdating(); }
 
-protected:
-	Model *model_{};
-	Unigine::Vector<IView *> views_;
+	Unigine::Vector<IBinding *> dirty_;
+	Unigine::Vector<IBinding *> polled_;
+	// dirty bindings without a visible view, oldest first
+	Unigine::Vector<IBinding *> offscreen_;
+	int64_t offscreen_budget_{200};
+	bool hidden_{false};
+	// layout of the current sortVisible() pass
+	VisibilityCache visibility_;
+	// staging list of the current parallel fetch
+	Unigine::Vector<IBinding *> fetched_;
 };
 
-// primary binding template
-template<typename T>
-class Binding
-{};
-
-
-template<typename T>
-class WidgetEditLineView final : public IView
+// A value posted for a binding from any thread, applied on the main thread.
+class PendingWrite
 {
 public:
-	WidgetEditLineView(Unigine::WidgetEditLinePtr w, Binding<T> *b)
-		: w_(w)
-		, b_(b)
-	{
-
-		Unigine::CallbackBase *cb = Unigine::MakeCallback([this]() {
-			b_->startUpdating();
-		});
-
-		start_edit_callback_ = w_->addCallback(Unigine::Gui::FOCUS_IN, cb);
+	PendingWrite(IBinding *binding, bool undoable)
+		: binding_(binding)
+		, undoable_(undoable)
+	{}
+	virtual ~PendingWrite() = default;
 
-		cb = Unigine::MakeCallback([this]() { w_->removeFocus(); });
+	virtual void apply() = 0;
+	// an interactive edit of the binding is in progress, the write waits for it to finish
+	virtual bool isBlocked() const = 0;
 
-		pressed_callback_ = w_->addCallback(Unigine::Gui::PRESSED, cb);
+	IBinding *getBinding() const { return binding_; }
+	bool isUndoable() const { return undoable_; }
 
-		cb = Unigine::MakeCallback([this]() {
-			b_->finishUpdating();
-		});
+private:
+	friend class WriteQueue;
 
-		finish_edit_callback_ = w_->addCallback(Unigine::Gui::FOCUS_OUT, cb);
+	IBinding *binding_{};
+	PendingWrite *next_{};
+	bool undoable_{true};
+};
 
-		cb = Unigine::MakeCallback([this]() {
-			const double valued = Unigine::String::atod(w_->getText());
-			b_->set(valued);
-		});
+// Multi-producer single-consumer queue of property writes. Producers push onto a lock-free
+// stack, the main thread takes the whole stack with one exchange and keeps only the latest
+// write of every binding. Bindings must outlive the writes posted for them.
+class WriteQueue
+{
+public:
+	~WriteQueue() { discard(); }
 
-		changed_callback_ = w_->addCallback(Unigine::Gui::CHANGED, cb);
+	// Thread-safe, takes ownership of the write.
+	void post(PendingWrite *write)
+	{
+		PendingWrite *head = head_.load(std::memory_order_relaxed);
+		do
+		{
+			write->next_ = head;
+		} while (!head_.compare_exchange_weak(head, write, std::memory_order_release,
+			std::memory_order_relaxed));
 	}
 
-	~WidgetEditLineView() override
+	// Main thread only. Applies the latest write of every binding in posting order.
+	void apply()
 	{
-		if (w_)
+		// the stack is newest first, so the first write seen for a binding wins
+		PendingWrite *write = head_.exchange(nullptr, std::memory_order_acquire);
+		while (write)
 		{
-			w_->removeCallback(Unigine::Gui::FOCUS_IN, start_edit_callback_);
-			w_->removeCallback(Unigine::Gui::FOCUS_OUT, finish_edit_callback_);
-			w_->removeCallback(Unigine::Gui::PRESSED, pressed_callback_);
-			w_->removeCallback(Unigine::Gui::CHANGED, changed_callback_);
+			PendingWrite *next = write->next_;
+			IBinding *binding = write->binding_;
+			if (binding->pending_write_)
+			{
+				delete write;
+			}
+			else
+			{
+				binding->pending_write_ = write;
+				latest_.append(write);
+			}
+			write = next;
 		}
-	}
 
-	void update() override
-	{
-		if (w_.isNull() || w_->isFocused())
+		if (latest_.empty() && deferred_.empty())
 		{
 			return;
 		}
 
-		auto value = b_->get();
+		// deferred writes are older than anything just posted
+		for (const auto &deferred : deferred_)
+		{
+			if (deferred->binding_->pending_write_)
+			{
+				delete deferred;
+			}
+			else
+			{
+				batch_.append(deferred);
+			}
+		}
+		deferred_.clear();
 
-		if (compare(Unigine::String::atof(w_->getText()), value))
+		for (int i = latest_.size() - 1; i >= 0; --i)
 		{
-			return;
+			batch_.append(latest_[i]);
+		}
+		latest_.clear();
+
+		for (const auto &pending : batch_)
+		{
+			pending->binding_->pending_write_ = nullptr;
+			if (pending->isBlocked())
+			{
+				deferred_.append(pending);
+			}
+			else
+			{
+				pending->apply();
+				delete pending;
+			}
 		}
+		batch_.clear();
+	}
+
+	bool isEmpty() const
+	{
+		return head_.load(std::memory_order_relaxed) == nullptr && deferred_.empty();
+	}
 
-		w_->setCallbackEnabled(Unigine::Gui::CHANGED, false);
-		w_->setText(Unigine::String::format("%.3f", value));
-		w_->setCallbackEnabled(Unigine::Gui::CHANGED, true);
+	// Main thread only, drops the writes not applied yet.
+	void discard()
+	{
+		clear(head_.exchange(nullptr, std::memory_order_acquire));
+		for (const auto &write : deferred_)
+		{
+			delete write;
+		}
+		deferred_.clear();
 	}
 
 private:
-	void *start_edit_callback_{};
-	void *pressed_callback_{};
-	void *finish_edit_callback_{};
-	void *changed_callback_{};
+	static void clear(PendingWrite *write)
+	{
+		while (write)
+		{
+			PendingWrite *next = write->next_;
+			delete write;
+			write = next;
+		}
+	}
 
-	Unigine::WidgetEditLinePtr w_;
-	Binding<T> *b_{};
+	std::atomic<PendingWrite *> head_{nullptr};
+	// main thread buffers, reused between frames
+	Unigine::Vector<PendingWrite *> latest_;
+	Unigine::Vector<PendingWrite *> batch_;
+	Unigine::Vector<PendingWrite *> deferred_;
 };
 
-template<typename T>
-class SliderView final : public IView
+inline void IBinding::invalidate()
 {
-public:
-	SliderView(Unigine::WidgetSliderPtr w, Binding<T> *b)
-		: w_(w)
-		, b_(b)
+	fetched_ = false;
+	if (queue_)
+	{
+		queue_->invalidate(this);
+	}
+	else
 	{
-		Unigine::CallbackBase *cb = Unigine::MakeCallback([this]() {
-			b_->startUpdating();
-			is_editing_ = true;
-		});
+		dirty_ = true;
+	}
+}
 
-		start_edit_callback_ = w_->addCallback(Unigine::Gui::PRESSED, cb);
+inline void IBinding::setPolling(bool enabled)
+{
+	assert(queue_ != nullptr);
+	queue_->setPolling(this, enabled);
+}
 
-		cb = Unigine::MakeCallback([this]() {
-			b_->finishUpdating();
-			is_editing_ = false;
-		});
+// A binding path hashed once, declare frequently used paths constexpr.
+struct BindingPath
+{
+	constexpr BindingPath(const char *path)
+		: path(path)
+		, hash(hash_string(path))
+	{}
 
-		finish_edit_callback_ = w_->addCallback(Unigine::Gui::RELEASED, cb);
+	const char *path;
+	uint32_t hash;
+};
 
-		cb = Unigine::MakeCallback([this]() {
-			b_->set(remap(w_->getMinValue(), w_->getMaxValue(), 0.0, 5.0, w_->getValue()));
-		});
+// Flat open-addressing index of named bindings with linear probing. Slots keep the
+// hash, so names are compared only on a hash match. Bindings must be named.
+class BindingRegistry
+{
+public:
+	// False if a binding with the same path or the same hash is already registered,
+	// journal records refer to bindings by the hash alone.
+	bool add(IBinding *binding)
+	{
+		assert(binding->getName() && *binding->getName());
+		if (find(binding->getNameHash()))
+		{
+			return false;
+		}
 
-		changed_callback_ = w_->addCallback(Unigine::Gui::CHANGED, cb);
+		if ((size_ + 1) * 2 > slots_.size())
+		{
+			grow();
+		}
+		insert(binding);
+		return true;
 	}
 
-	~SliderView() override
+	IBinding *find(const BindingPath &path) const
 	{
-		if (w_)
+		if (slots_.empty())
 		{
-			w_->removeCallback(Unigine::Gui::PRESSED, start_edit_callback_);
-			w_->removeCallback(Unigine::Gui::RELEASED, finish_edit_callback_);
-			w_->removeCallback(Unigine::Gui::CHANGED, changed_callback_);
+			return nullptr;
 		}
+
+		const int mask = slots_.size() - 1;
+		for (int i = static_cast<int>(path.hash) & mask; slots_[i].binding; i = (i + 1) & mask)
+		{
+			if (slots_[i].hash == path.hash && strcmp(slots_[i].binding->getName(), path.path) == 0)
+			{
+				return slots_[i].binding;
+			}
+		}
+		return nullptr;
 	}
 
-	void update() override
+	// hashes are unique, see add()
+	IBinding *find(uint32_t hash) const
 	{
-		if (is_editing_)
+		if (slots_.empty())
 		{
-			return;
+			return nullptr;
+		}
+
+		const int mask = slots_.size() - 1;
+		for (int i = static_cast<int>(hash) & mask; slots_[i].binding; i = (i + 1) & mask)
+		{
+			if (slots_[i].hash == hash)
+			{
+				return slots_[i].binding;
+			}
 		}
+		return nullptr;
+	}
 
-		auto value = b_->get();
+	int size() const { return size_; }
 
-		w_->setCallbackEnabled(Unigine::Gui::CHANGED, false);
-		w_->setValue(remap(0.0, 5.0, w_->getMinValue(), w_->getMaxValue(), value));
-		w_->setCallbackEnabled(Unigine::Gui::CHANGED, true);
+	void clear()
+	{
+		slots_.clear();
+		size_ = 0;
 	}
 
 private:
-	double remap(double in_min, double in_max, double out_min, double out_max, double in_v)
+	static constexpr int MIN_CAPACITY = 16;
+
+	struct Slot
+	{
+		uint32_t hash{0};
+		IBinding *binding{};
+	};
+
+	void insert(IBinding *binding)
 	{
-		using namespace Unigine::Math;
-		return lerp(out_min, out_max, inverseLerp(in_min, in_max, in_v));
+		const int mask = slots_.size() - 1;
+		int i = static_cast<int>(binding->getNameHash()) & mask;
+		while (slots_[i].binding)
+		{
+			i = (i + 1) & mask;
+		}
+		slots_[i] = Slot{binding->getNameHash(), binding};
+		++size_;
 	}
 
-	void *start_edit_callback_{};
-	void *finish_edit_callback_{};
-	void *changed_callback_{};
+	void grow()
+	{
+		Unigine::Vector<Slot> slots;
+		slots.resize(slots_.empty() ? MIN_CAPACITY : slots_.size() * 2);
+		slots_.swap(slots);
+
+		size_ = 0;
+		for (const auto &slot : slots)
+		{
+			if (slot.binding)
+			{
+				insert(slot.binding);
+			}
+		}
+	}
 
-	bool is_editing_{false};
-	Unigine::WidgetSliderPtr w_;
-	Binding<T> *b_{};
+	Unigine::Vector<Slot> slots_;
+	int size_{0};
 };
 
-template<>
-class Binding<float> final : public BindingTemplate<float>
+// Instance sources, they are called on every get/set so keep them trivial.
+// Undo commands keep the Ref of the instance they were made on and resolve it
+// on undo and redo, a null instance makes them a no-op.
+
+// Ref of sources with no stable handle, the instance must outlive the history.
+template<typename InstanceT>
+class InstanceRef
 {
 public:
-	explicit Binding(Model *model)
-		: BindingTemplate<float>(model)
+	InstanceRef(InstanceT *instance = nullptr)
+		: instance_(instance)
 	{}
 
-	IBinding *attach(Unigine::WidgetPtr w) override
-	{
-		if (auto edit_line = Unigine::checked_ptr_cast<Unigine::WidgetEditLine>(w))
-		{
-			return attach(edit_line);
-		}
-		else if (auto slider = Unigine::checked_ptr_cast<Unigine::WidgetSlider>(w))
-		{
-			return attach(slider);
-		}
+	InstanceT *get() const { return instance_; }
 
-		assert(false); // or log error/fatal
-		return this;
-	}
+	bool operator==(const InstanceRef &other) const { return instance_ == other.instance_; }
+	bool operator!=(const InstanceRef &other) const { return instance_ != other.instance_; }
+
+private:
+	InstanceT *instance_{};
+};
+
+// Follows a smart pointer owned by the caller, the pointer may be reassigned at any time.
+template<typename InstanceT>
+class PtrInstance
+{
+public:
+	using Instance = InstanceT;
+	using Ref = InstanceRef<InstanceT>;
+
+	PtrInstance(const Unigine::Ptr<InstanceT> &ptr)
+		: ptr_(&ptr)
+	{}
+
+	InstanceT *operator()() const { return ptr_->get(); }
+	Ref getRef() const { return ptr_->get(); }
+
+private:
+	const Unigine::Ptr<InstanceT> *ptr_{};
+};
+
+// Runtime fallback for instances that can't be expressed as a pointer.
+template<typename InstanceT>
+class FunctionInstance
+{
+public:
+	using Instance = InstanceT;
+	using Ref = InstanceRef<InstanceT>;
+
+	FunctionInstance(std::function<InstanceT *()> getter)
+		: getter_(std::move(getter))
+	{}
+
+	InstanceT *operator()() const { return getter_(); }
+	Ref getRef() const { return getter_(); }
+
+private:
+	std::function<InstanceT *()> getter_;
+};
+
+// Follows a selection owned by the caller, the selection may change at any time.
+template<typename InstanceT>
+class PtrSelection
+{
+public:
+	using Instance = InstanceT;
+	using Ref = InstanceRef<InstanceT>;
+
+	PtrSelection(const Unigine::Vector<Unigine::Ptr<InstanceT>> &selection)
+		: selection_(&selection)
+	{}
+
+	int size() const { return selection_->size(); }
+	InstanceT *operator[](int i) const { return selection_->at(i).get(); }
+	Ref getRef(int i) const { return selection_->at(i).get(); }
+
+private:
+	const Unigine::Vector<Unigine::Ptr<InstanceT>> *selection_{};
+};
+
+// Accessors resolve the property at compile time. Any type with the same
+// members can be used as an accessor, e.g. to bind free functions.
+template<auto Getter, auto Setter>
+class MemberAccessor
+{
+public:
+	using Ret = typename function_traits<function_signature<Getter>>::result_type;
+	using Arg = typename function_traits<function_signature<Setter>>::template arg<0>::type;
+	using Value = std::decay_t<Ret>;
 
-	Binding<float> *attach(Unigine::WidgetEditLinePtr w)
+	template<typename InstanceT>
+	static Ret get(InstanceT *instance)
 	{
-		auto view = new WidgetEditLineView<float>(w, this);
-		views_.append(view);
-		return this;
+		return (instance->*Getter)();
 	}
 
-	Binding<float> *attach(Unigine::WidgetSliderPtr w)
+	template<typename InstanceT>
+	static void set(InstanceT *instance, Arg v)
 	{
-		auto view = new SliderView<float>(w, this);
-		views_.append(view);
-		return this;
+		(instance->*Setter)(v);
 	}
 };
 
-template<typename InstanceT, typename T>
-class UndoRedoModel final : public IModel<T>
+// Marks an accessor whose getter is a pure read, safe to call from worker threads.
+template<typename Accessor>
+struct ConcurrentGet : Accessor
 {
-public:
-	using InstanceGetter = std::function<InstanceT *()>;
+	static constexpr bool concurrent_get = true;
+};
 
-	using Getter = std::function<T(InstanceT *)>;
-	using Setter = std::function<void(InstanceT *, const T &)>;
+template<typename Accessor, typename = void>
+struct is_concurrent_get : std::false_type
+{};
 
-	UndoRedoModel(UndoStack &undo_stack, const InstanceGetter &instance_getter, Getter getter,
-		Setter setter)
-		: undo_stack_(undo_stack)
-		, instance_getter_(instance_getter)
-		, getter_(std::move(getter))
-		, setter_(std::move(setter))
+template<typename Accessor>
+struct is_concurrent_get<Accessor, std::void_t<decltype(Accessor::concurrent_get)>>
+	: std::bool_constant<Accessor::concurrent_get>
+{};
+
+template<typename Source, typename Accessor>
+class UndoRedoModel final
+{
+public:
+	using InstanceT = typename Source::Instance;
+	using Ref = typename Source::Ref;
+	using Value = typename Accessor::Value;
+	using Arg = typename Accessor::Arg;
+	using Component = typename ValueTraits<Value>::Component;
+	static constexpr bool concurrent_get = is_concurrent_get<Accessor>::value;
+
+	UndoRedoModel(IBinding *binding, UndoStack &undo_stack, const Source &source)
+		: binding_(binding)
+		, undo_stack_(undo_stack)
+		, source_(source)
 	{}
 
-	T get() const override
+	~UndoRedoModel() { delete transaction_; }
+
+	// a default value while there is no instance
+	Value get() const
 	{
-		return getter_(instance_getter_());
+		InstanceT *instance = source_();
+		if (!instance)
+		{
+			return Value{};
+		}
+
+		BINDS_STATS_COUNT(binding_, num_gets);
+		return Accessor::get(instance);
 	}
 
-	bool set(const T &v) override
+	bool set(Arg v)
 	{
-		if (compare(getter_(instance_getter_()), v))
+		InstanceT *instance = source_();
+		if (!instance)
+		{
+			return false;
+		}
+
+		BINDS_STATS_COUNT(binding_, num_gets);
+		if (compare(Value(Accessor::get(instance)), Value(v)))
 		{
 			return false;
 		}
@@ -319,22 +781,56 @@ public:
 		}
 		else
 		{
-			undo_stack_.push(new Transaction(instance_getter_(), getter_, setter_));
+			auto transaction = undo_stack_.create<Transaction>(binding_, instance, source_.getRef(),
+				&last_value_);
+			transaction->update(v);
+			last_value_ = transaction->getNewValue();
+			undo_stack_.push(transaction);
 		}
 		return true;
 	}
 
-	void startUpdating() override
+	bool setComponent(int index, Component component)
 	{
-		if (isUpdating())
+		Value value = get();
+		ValueTraits<Value>::set(value, index, component);
+		return set(value);
+	}
+
+	// writes without recording an undo step
+	bool assign(Arg v)
+	{
+		InstanceT *instance = source_();
+		if (!instance)
+		{
+			return false;
+		}
+
+		BINDS_STATS_COUNT(binding_, num_gets);
+		if (compare(Value(Accessor::get(instance)), Value(v)))
+		{
+			return false;
+		}
+
+		BINDS_STATS_COUNT(binding_, num_sets);
+		Accessor::set(instance, v);
+		binding_->invalidate();
+		return true;
+	}
+
+	void startUpdating()
+	{
+		InstanceT *instance = source_();
+		if (isUpdating() || !instance)
 		{
 			return;
 		}
 
-		transaction_ = new Transaction(instance_getter_(), getter_, setter_);
+		transaction_ = undo_stack_.create<Transaction>(binding_, instance, source_.getRef(),
+			&last_value_);
 	}
 
-	void finishUpdating() override
+	void finishUpdating()
 	{
 		if (!isUpdating())
 		{
@@ -343,6 +839,7 @@ public:
 
 		if (transaction_->hasModifications())
 		{
+			last_value_ = transaction_->getNewValue();
 			undo_stack_.push(transaction_);
 		}
 		else
@@ -353,7 +850,7 @@ public:
 		transaction_ = nullptr;
 	}
 
-	void cancelUpdating() override
+	void cancelUpdating()
 	{
 		if (!isUpdating())
 		{
@@ -365,100 +862,1012 @@ public:
 		transaction_ = nullptr;
 	}
 
-	bool isUpdating() const override { return transaction_; }
+	bool isUpdating() const { return transaction_; }
+	bool isMixed() const { return false; }
+
+	// looks the instance up, e.g. node handles cache the node for the epoch
+	void resolve() const { source_(); }
+
+	UndoCommand *read(UndoReader &reader)
+	{
+		if constexpr (std::is_trivially_copyable_v<Value>)
+		{
+			Value old_value{};
+			Value new_value{};
+			if (source_() && reader.read(old_value) && reader.read(new_value))
+			{
+				return undo_stack_.create<Transaction>(binding_, source_.getRef(), old_value, new_value);
+			}
+		}
+		return nullptr;
+	}
 
 private:
+	using Storage = ValueStorage<Value>;
+
+	// Large values are stored as shared immutable buffers, the old value of an
+	// edit shares data with the new value of the previous one.
 	class Transaction final : public UndoCommand
 	{
 	public:
-		Transaction(InstanceT *instance, const Getter &getter, const Setter &setter)
-			: instance_(instance)
-			, setter_(setter)
-			, old_value_(getter(instance))
+		Transaction(IBinding *binding, InstanceT *instance, const Ref &ref, const Storage *base)
+			: binding_(binding->getHandle())
+			, instance_(ref)
+			, old_value_(Accessor::get(instance), base)
 			, new_value_(old_value_)
+		{
+			BINDS_STATS_COUNT(binding, num_gets);
+		}
+
+		Transaction(IBinding *binding, const Ref &ref, const Value &old_value, const Value &new_value)
+			: binding_(binding->getHandle())
+			, instance_(ref)
+			, old_value_(old_value, nullptr)
+			, new_value_(new_value, &old_value_)
 		{}
 
-		void update(const T &v) { new_value_ = v; }
+		void update(Arg v) { new_value_ = Storage(v, &old_value_); }
 
-		bool hasModifications() const { return !compare(new_value_, old_value_); }
+		bool hasModifications() const { return !new_value_.equals(old_value_); }
 
-		void redo() override
+		const Storage &getNewValue() const { return new_value_; }
+
+		int id() const override { return typeId<Transaction>(); }
+
+		size_t getMemoryUsage() const override
 		{
-			setter_(instance_, new_value_);
+			return sizeof(Transaction) + old_value_.getMemoryUsage() + new_value_.getMemoryUsage();
 		}
 
-		void undo() override
+		uint32_t getJournalType() const override
 		{
-			setter_(instance_, old_value_);
+			const IBinding *binding = binding_.get();
+			return std::is_trivially_copyable_v<Value> && binding ? binding->getNameHash() : 0;
 		}
 
-	private:
-		InstanceT *instance_{};
-		const Setter &setter_;
-		T old_value_;
-		T new_value_;
-	};
+		void write(UndoWriter &writer) const override
+		{
+			if constexpr (std::is_trivially_copyable_v<Value>)
+			{
+				writer.write(old_value_.get());
+				writer.write(new_value_.get());
+			}
+		}
 
-	UndoStack &undo_stack_;
-	InstanceGetter instance_getter_;
-	Getter getter_;
-	Setter setter_;
-	Transaction *transaction_{nullptr};
-};
+		bool mergeWith(const UndoCommand *other) override
+		{
+			auto transaction = static_cast<const Transaction *>(other);
+			if (transaction->instance_ != instance_)
+			{
+				return false;
+			}
+
+			// the merged command goes away, its value is accounted to this one
+			new_value_ = Storage(transaction->new_value_, &old_value_);
+			return true;
+		}
 
-template<typename InstanceT>
-class Binder
+		void redo() override { apply(new_value_); }
+		void undo() override { apply(old_value_); }
+
+	private:
+		void apply(const Storage &value)
+		{
+			InstanceT *instance = instance_.get();
+			if (!instance)
+			{
+				return;
+			}
+
+			Accessor::set(instance, value.get());
+
+			// the binding is gone once the binder is cleared
+			if (IBinding *binding = binding_.get())
+			{
+				BINDS_STATS_COUNT(binding, num_sets);
+				binding->invalidate();
+			}
+		}
+
+		ArenaHandle<IBinding> binding_;
+		Ref instance_;
+		Storage old_value_;
+		Storage new_value_;
+	};
+
+	IBinding *binding_{};
+	UndoStack &undo_stack_;
+	Source source_;
+	Transaction *transaction_{nullptr};
+	// new value of the last committed edit, the next edit shares data with it
+	Storage last_value_;
+};
+
+enum class ApplyMode
+{
+	Absolute, // every instance gets the new value
+	Relative, // every instance is offset by the change of the displayed value
+};
+
+// Binds a property across a selection. The displayed value is the one of the
+// first instance, the whole selection is written in one batch and lands in
+// the undo stack as a single command.
+template<typename Selection, typename Accessor>
+class SelectionModel final
+{
+public:
+	using InstanceT = typename Selection::Instance;
+	using Ref = typename Selection::Ref;
+	using Value = typename Accessor::Value;
+	using Arg = typename Accessor::Arg;
+	using Component = typename ValueTraits<Value>::Component;
+	static constexpr bool concurrent_get = is_concurrent_get<Accessor>::value;
+
+	SelectionModel(IBinding *binding, UndoStack &undo_stack, const Selection &selection)
+		: binding_(binding)
+		, undo_stack_(undo_stack)
+		, selection_(selection)
+	{}
+
+	~SelectionModel() { delete transaction_; }
+
+	Value get() const
+	{
+		if (selection_.size() == 0)
+		{
+			return Value{};
+		}
+
+		BINDS_STATS_COUNT(binding_, num_gets);
+		return Accessor::get(selection_[0]);
+	}
+
+	// looks the instances up, e.g. node handles cache the nodes for the epoch
+	void resolve() const
+	{
+		for (int i = 0; i < selection_.size(); ++i)
+		{
+			selection_[i];
+		}
+	}
+
+	bool isMixed() const
+	{
+		const int size = selection_.size();
+		if (size < 2)
+		{
+			return false;
+		}
+
+		const Value first = Accessor::get(selection_[0]);
+		BINDS_STATS_COUNT(binding_, num_gets);
+		for (int i = 1; i < size; ++i)
+		{
+			BINDS_STATS_COUNT(binding_, num_gets);
+			if (!compare(first, Value(Accessor::get(selection_[i]))))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool set(Arg v)
+	{
+		if (selection_.size() == 0)
+		{
+			return false;
+		}
+
+		if (isUpdating())
+		{
+			transaction_->update(v);
+			transaction_->redo();
+			return true;
+		}
+
+		auto transaction = undo_stack_.create<Transaction>(binding_, selection_, mode_);
+		transaction->update(v);
+		if (!transaction->hasModifications())
+		{
+			delete transaction;
+			return false;
+		}
+
+		undo_stack_.push(transaction);
+		return true;
+	}
+
+	// In the absolute mode only the component is written, the other ones of
+	// each instance are kept.
+	bool setComponent(int index, Component component)
+	{
+		if (selection_.size() == 0)
+		{
+			return false;
+		}
+
+		Value value = get();
+		ValueTraits<Value>::set(value, index, component);
+
+		if (isUpdating())
+		{
+			transaction_->update(value, index);
+			transaction_->redo();
+			return true;
+		}
+
+		auto transaction = undo_stack_.create<Transaction>(binding_, selection_, mode_);
+		transaction->update(value, index);
+		if (!transaction->hasModifications())
+		{
+			delete transaction;
+			return false;
+		}
+
+		undo_stack_.push(transaction);
+		return true;
+	}
+
+	// writes without recording an undo step, the apply mode still holds
+	bool assign(Arg v)
+	{
+		if (selection_.size() == 0)
+		{
+			return false;
+		}
+
+		Transaction transaction(binding_, selection_, mode_);
+		transaction.update(v);
+		if (!transaction.hasModifications())
+		{
+			return false;
+		}
+
+		transaction.redo();
+		return true;
+	}
+
+	void startUpdating()
+	{
+		if (isUpdating())
+		{
+			return;
+		}
+
+		transaction_ = undo_stack_.create<Transaction>(binding_, selection_, mode_);
+	}
+
+	void finishUpdating()
+	{
+		if (!isUpdating())
+		{
+			return;
+		}
+
+		if (transaction_->hasModifications())
+		{
+			undo_stack_.push(transaction_);
+		}
+		else
+		{
+			delete transaction_;
+		}
+
+		transaction_ = nullptr;
+	}
+
+	void cancelUpdating()
+	{
+		if (!isUpdating())
+		{
+			return;
+		}
+
+		transaction_->undo();
+		delete transaction_;
+		transaction_ = nullptr;
+	}
+
+	bool isUpdating() const { return transaction_; }
+
+	// takes effect from the next edit
+	void setApplyMode(ApplyMode mode) { mode_ = mode; }
+	ApplyMode getApplyMode() const { return mode_; }
+
+	// journaled edits are restored only if the selection has the same size
+	UndoCommand *read(UndoReader &reader)
+	{
+		if constexpr (std::is_trivially_copyable_v<Value>)
+		{
+			uint8_t mode = 0;
+			int32_t size = 0;
+			if (!reader.read(mode) || !reader.read(size) || size != selection_.size())
+			{
+				return nullptr;
+			}
+
+			auto transaction = undo_stack_.create<Transaction>(binding_, selection_,
+				static_cast<ApplyMode>(mode));
+			if (transaction->read(reader))
+			{
+				return transaction;
+			}
+			delete transaction;
+		}
+		return nullptr;
+	}
+
+private:
+	class Transaction final : public UndoCommand
+	{
+	public:
+		Transaction(IBinding *binding, const Selection &selection, ApplyMode mode)
+			: binding_(binding->getHandle())
+			, mode_(mode)
+		{
+			const int size = selection.size();
+			instances_.resize(size);
+			old_values_.resize(size);
+			for (int i = 0; i < size; ++i)
+			{
+				instances_[i] = selection.getRef(i);
+				old_values_[i] = Accessor::get(selection[i]);
+			}
+			BINDS_STATS_ADD(binding, num_gets, size);
+
+			if (size > 0)
+			{
+				new_value_ = old_values_[0];
+			}
+		}
+
+		uint32_t getJournalType() const override
+		{
+			const IBinding *binding = binding_.get();
+			return std::is_trivially_copyable_v<Value> && binding ? binding->getNameHash() : 0;
+		}
+
+		void write(UndoWriter &writer) const override
+		{
+			if constexpr (std::is_trivially_copyable_v<Value>)
+			{
+				writer.write(static_cast<uint8_t>(mode_));
+				writer.write(static_cast<int32_t>(old_values_.size()));
+				writer.write(old_values_.get(), old_values_.size() * sizeof(Value));
+				writer.write(new_value_);
+				writer.write(static_cast<int8_t>(component_));
+			}
+		}
+
+		bool read(UndoReader &reader)
+		{
+			int8_t component = -1;
+			if (!reader.read(old_values_.get(), old_values_.size() * sizeof(Value))
+				|| !reader.read(new_value_) || !reader.read(component)
+				|| component >= ValueTraits<Value>::size)
+			{
+				return false;
+			}
+			component_ = component;
+			return true;
+		}
+
+		void update(Arg v)
+		{
+			new_value_ = v;
+			component_ = -1;
+		}
+
+		void update(const Value &v, int component)
+		{
+			new_value_ = v;
+			component_ = component;
+		}
+
+		bool hasModifications() const
+		{
+			if (isRelative())
+			{
+				return !old_values_.empty() && !compare(new_value_, old_values_[0]);
+			}
+
+			const int size = old_values_.size();
+			for (int i = 0; i < size; ++i)
+			{
+				if (!compare(getNewValue(i), old_values_[i]))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		int id() const override { return typeId<Transaction>(); }
+
+		size_t getMemoryUsage() const override
+		{
+			return sizeof(Transaction)
+				+ instances_.size() * (sizeof(Ref) + sizeof(Value));
+		}
+
+		bool mergeWith(const UndoCommand *other) override
+		{
+			auto transaction = static_cast<const Transaction *>(other);
+			if (transaction->mode_ != mode_ || transaction->component_ != component_
+				|| transaction->instances_.size() != instances_.size())
+			{
+				return false;
+			}
+
+			const int size = instances_.size();
+			for (int i = 0; i < size; ++i)
+			{
+				if (transaction->instances_[i] != instances_[i])
+				{
+					return false;
+				}
+			}
+
+			// both deltas are relative to the first displayed value, so the last one wins
+			new_value_ = transaction->new_value_;
+			return true;
+		}
+
+		void redo() override
+		{
+			const int size = instances_.size();
+			if (isRelative())
+			{
+				if constexpr (is_relative_value_v<Value>)
+				{
+					const Value delta = new_value_ - old_values_[0];
+					for (int i = 0; i < size; ++i)
+					{
+						if (InstanceT *instance = instances_[i].get())
+						{
+							Accessor::set(instance, old_values_[i] + delta);
+						}
+					}
+				}
+			}
+			else
+			{
+				for (int i = 0; i < size; ++i)
+				{
+					if (InstanceT *instance = instances_[i].get())
+					{
+						Accessor::set(instance, getNewValue(i));
+					}
+				}
+			}
+			refresh(size);
+		}
+
+		void undo() override
+		{
+			const int size = instances_.size();
+			for (int i = 0; i < size; ++i)
+			{
+				if (InstanceT *instance = instances_[i].get())
+				{
+					Accessor::set(instance, old_values_[i]);
+				}
+			}
+			refresh(size);
+		}
+
+	private:
+		bool isRelative() const
+		{
+			return mode_ == ApplyMode::Relative && is_relative_value_v<Value>;
+		}
+
+		// absolute value of the instance
+		Value getNewValue(int i) const
+		{
+			if (component_ < 0)
+			{
+				return new_value_;
+			}
+
+			Value value = old_values_[i];
+			ValueTraits<Value>::set(value, component_,
+				ValueTraits<Value>::get(new_value_, component_));
+			return value;
+		}
+
+		// the binding is gone once the binder is cleared
+		void refresh(int num_instances)
+		{
+			if (IBinding *binding = binding_.get())
+			{
+				BINDS_STATS_ADD(binding, num_sets, num_instances);
+				binding->invalidate();
+			}
+		}
+
+		ArenaHandle<IBinding> binding_;
+		ApplyMode mode_{ApplyMode::Absolute};
+		// the only component written in the absolute mode, -1 for the whole value
+		int component_{-1};
+		Unigine::Vector<Ref> instances_;
+		Unigine::Vector<Value> old_values_;
+		Value new_value_{};
+	};
+
+	IBinding *binding_{};
+	UndoStack &undo_stack_;
+	Selection selection_;
+	ApplyMode mode_{ApplyMode::Absolute};
+	Transaction *transaction_{nullptr};
+};
+
+// Selection sources are recognized by their size().
+template<typename Source, typename Accessor, typename = void>
+struct DefaultModel
+{
+	using Type = UndoRedoModel<Source, Accessor>;
+};
+
+template<typename Source, typename Accessor>
+struct DefaultModel<Source, Accessor, std::void_t<decltype(std::declval<const Source &>().size())>>
+{
+	using Type = SelectionModel<Source, Accessor>;
+};
+
+// Owns its model, so the whole get/compare/set path is resolved at compile time.
+// Views are the only runtime-polymorphic part, they are attached dynamically and
+// live in the arena of the binder.
+template<typename Model>
+class Binding final : public IBinding
 {
 public:
-	using InstanceGetter = std::function<InstanceT *()>;
+	using Value = typename Model::Value;
+	using Arg = typename Model::Arg;
+
+	template<typename... Args>
+	explicit Binding(Arena &arena, Args &&...args)
+		: model_(this, std::forward<Args>(args)...)
+		, arena_(arena)
+	{
+		concurrent_ = Model::concurrent_get;
+	}
+
+	ArenaHandle<IBinding> getHandle() override { return ArenaHandle<IBinding>(this, arena_); }
+
+	Value get() const { return fetched_ ? fetched_value_ : model_.get(); }
+
+	// The model invalidates the binding on a write, the views are refreshed once
+	// by the next Binder::update().
+	void set(Arg v)
+	{
+		TRACE_SCOPE("Model::set", getName());
+		BINDS_STATS_TIME(this);
+		model_.set(v);
+	}
+
+	// writes a single component, e.g. of a mixed selection
+	void setComponent(int index, typename Model::Component component)
+	{
+		TRACE_SCOPE("Model::set", getName());
+		BINDS_STATS_TIME(this);
+		model_.setComponent(index, component);
+	}
+
+	// same as set() but not undoable, for values computed by the application
+	void assign(Arg v)
+	{
+		TRACE_SCOPE("Model::assign", getName());
+		BINDS_STATS_TIME(this);
+		model_.assign(v);
+	}
+
+	void update() override
+	{
+		for (const auto &attached : views_)
+		{
+			TRACE_SCOPE("IView::update", getName());
+			attached.view->update();
+		}
+		fetched_ = false;
+	}
+
+	bool isVisible(VisibilityCache &cache) const override
+	{
+		for (const auto &attached : views_)
+		{
+			if (attached.view->isVisible(cache))
+			{
+				return true;
+			}
+		}
+		return views_.empty();
+	}
+
+	void prepareFetch() override { model_.resolve(); }
+
+	void fetch() override
+	{
+		BINDS_STATS_TIME(this);
+		fetched_value_ = model_.get();
+		fetched_mixed_ = model_.isMixed();
+		fetched_ = true;
+	}
+
+	void startUpdating()
+	{
+		TRACE_SCOPE("Model::startUpdating", getName());
+		model_.startUpdating();
+	}
+
+	void finishUpdating()
+	{
+		TRACE_SCOPE("Model::finishUpdating", getName());
+		model_.finishUpdating();
+	}
+
+	void cancelUpdating()
+	{
+		TRACE_SCOPE("Model::cancelUpdating", getName());
+		model_.cancelUpdating();
+	}
+
+	bool isUpdating() const { return model_.isUpdating(); }
+	bool isMixed() const { return fetched_ ? fetched_mixed_ : model_.isMixed(); }
+
+	Model &getModel() { return model_; }
+
+	UndoCommand *read(UndoReader &reader) override { return model_.read(reader); }
+
+	const void *getType() const override { return type_tag<Binding>(); }
+	const void *getValueType() const override { return type_tag<Value>(); }
+	void setValue(const void *value) override { set(*static_cast<const Value *>(value)); }
+	void getValue(void *value) const override { *static_cast<Value *>(value) = get(); }
+
+	// number of fractional digits shown by text views
+	void setPrecision(int precision) { precision_ = precision; }
+	int getPrecision() const { return precision_; }
+
+	// value range of slider views
+	void setRange(double min, double max)
+	{
+		min_value_ = min;
+		max_value_ = max;
+	}
+	double getMinValue() const { return min_value_; }
+	double getMaxValue() const { return max_value_; }
+
+	IBinding *attach(Unigine::WidgetPtr w) override
+	{
+		if constexpr (std::is_same_v<Value, bool>)
+		{
+			if (auto check_box = Unigine::checked_ptr_cast<Unigine::WidgetCheckBox>(w))
+			{
+				return attach(check_box);
+			}
+		}
+		else if constexpr (is_number_value_v<Value> || std::is_enum_v<Value>)
+		{
+			if (auto combo_box = Unigine::checked_ptr_cast<Unigine::WidgetComboBox>(w))
+			{
+				return attach(combo_box);
+			}
+		}
+
+		if constexpr (is_number_value_v<Value>)
+		{
+			if (auto edit_line = Unigine::checked_ptr_cast<Unigine::WidgetEditLine>(w))
+			{
+				return attach(edit_line);
+			}
+			else if (auto slider = Unigine::checked_ptr_cast<Unigine::WidgetSlider>(w))
+			{
+				return attach(slider);
+			}
+		}
+		else if constexpr (is_vector_value_v<Value>)
+		{
+			// a container with one edit line per component
+			Unigine::Vector<Unigine::WidgetEditLinePtr> fields;
+			for (int i = 0; i < w->getNumChildren(); ++i)
+			{
+				auto edit_line = Unigine::checked_ptr_cast<Unigine::WidgetEditLine>(w->getChild(i));
+				if (edit_line)
+				{
+					fields.append(edit_line);
+				}
+			}
+
+			if (fields.size() == ValueTraits<Value>::size)
+			{
+				return attach(fields);
+			}
+		}
 
-	template <typename T>
-	using Getter = std::function<T(InstanceT *)>;
+		assert(false); // or log error/fatal
+		return this;
+	}
 
-	template <typename T>
-	using Setter = std::function<void(InstanceT *, const T &)>;
+	Binding *attach(Unigine::WidgetEditLinePtr w)
+	{
+		return attach<WidgetEditLineView<Binding>>(w);
+	}
 
+	Binding *attach(Unigine::WidgetSliderPtr w)
+	{
+		return attach<SliderView<Binding>>(w);
+	}
+
+	Binding *attach(Unigine::WidgetCheckBoxPtr w)
+	{
+		return attach<CheckBoxView<Binding>>(w);
+	}
+
+	Binding *attach(Unigine::WidgetComboBoxPtr w)
+	{
+		return attach<ComboBoxView<Binding>>(w);
+	}
+
+	Binding *attach(const Unigine::Vector<Unigine::WidgetEditLinePtr> &fields)
+	{
+		return attach<MultiEditLineView<Binding>>(fields);
+	}
 
-	Binder(UndoStack &undo_stack, InstanceGetter instance_getter)
+	template<typename View, typename WidgetPtrT>
+	Binding *attach(const WidgetPtrT &w)
+	{
+		auto destroy = [](Arena &arena, IView *view) { arena.destroy(static_cast<View *>(view)); };
+		views_.append(AttachedView{arena_.create<View>(w, this), destroy});
+		invalidate();
+		return this;
+	}
+
+	void detach(const Unigine::WidgetPtr &widget) override
+	{
+		for (int i = views_.size() - 1; i >= 0; --i)
+		{
+			if (views_[i].view->isInside(widget))
+			{
+				views_[i].destroy(arena_, views_[i].view);
+				views_.removeAt(i);
+			}
+		}
+	}
+
+private:
+	struct AttachedView
+	{
+		IView *view;
+		// picks the arena pool of the concrete view type
+		void (*destroy)(Arena &arena, IView *view);
+	};
+
+	Model model_;
+	Arena &arena_;
+	Value fetched_value_{};
+	bool fetched_mixed_{false};
+	int precision_{3};
+	double min_value_{0.0};
+	double max_value_{5.0};
+	Unigine::Vector<AttachedView> views_;
+};
+
+template<typename BindingT>
+class BindingWrite final : public PendingWrite
+{
+public:
+	using Value = typename BindingT::Value;
+
+	BindingWrite(BindingT *binding, const Value &value, bool undoable)
+		: PendingWrite(binding, undoable)
+		, binding_(binding)
+		, value_(value)
+	{}
+
+	void apply() override
+	{
+		if (isUndoable())
+		{
+			binding_->set(value_);
+		}
+		else
+		{
+			binding_->assign(value_);
+		}
+	}
+
+	bool isBlocked() const override { return binding_->isUpdating(); }
+
+private:
+	BindingT *binding_{};
+	Value value_;
+};
+
+// Owns its bindings, their models and views, they are destroyed together with the
+// binder or by clear(). Undo commands refer to the bindings through an ArenaHandle,
+// history recorded through them stays undoable afterwards and still writes the
+// instances, only the views refresh is skipped.
+template<typename InstanceT, typename Source = PtrInstance<InstanceT>>
+class Binder final : public UndoCommandFactory
+{
+public:
+	Binder(UndoStack &undo_stack, const Source &source)
 		: undo_stack_(undo_stack)
-		, instance_getter_(instance_getter)
+		, source_(source)
 	{}
 
-	Binding<float> *create(float (InstanceT::*getter)() const, void (InstanceT::*setter)(float))
+	template<auto Getter, auto Setter>
+	auto create(const char *name = nullptr)
 	{
-		auto get = [getter](const InstanceT *instance) {
-			return (instance->*getter)();
-		};
-		auto set = [setter](InstanceT *instance, float v) {
-			(instance->*setter)(v);
-		};
+		return create<MemberAccessor<Getter, Setter>>(source_, name);
+	}
 
-		return create<float>(std::move(get), std::move(set));
+	template<typename Accessor>
+	auto create(const char *name = nullptr)
+	{
+		return create<Accessor>(source_, name);
 	}
 
-	template<typename T>
-	Binding<T> *create(Getter<T> getter, Setter<T> setter)
+	// Binds to another source than the one of the binder, e.g. to a row of a table.
+	template<auto Getter, auto Setter>
+	auto create(const Source &source, const char *name = nullptr)
+	{
+		return create<MemberAccessor<Getter, Setter>>(source, name);
+	}
+
+	template<typename Accessor>
+	auto create(const Source &source, const char *name = nullptr)
 	{
-		auto *model = new UndoRedoModel<InstanceT, T>(undo_stack_, instance_getter_,
-			std::move(getter), std::move(setter));
+		using Model = typename DefaultModel<Source, Accessor>::Type;
 
-		auto binding = new Binding<T>(model);
+		auto binding = arena_.create<Binding<Model>>(arena_, undo_stack_, source);
+		if (name)
+		{
+			binding->setName(name);
+			if (!registry_.add(binding))
+			{
+				const IBinding *other = registry_.find(binding->getNameHash());
+				if (strcmp(other->getName(), name) == 0)
+				{
+					Unigine::Log::error("Binder::create(): duplicate binding path \"%s\"\n", name);
+				}
+				else
+				{
+					Unigine::Log::error("Binder::create(): binding path \"%s\" has the hash of \"%s\"\n",
+						name, other->getName());
+				}
+				binding->setName("");
+			}
+		}
 		bindings_.append(binding);
+		queue_.add(binding);
 		return binding;
 	}
 
+	UndoCommand *read(uint32_t type, UndoReader &reader) override
+	{
+		IBinding *binding = registry_.find(type);
+		return binding ? binding->read(reader) : nullptr;
+	}
+
+	// Lookup by the name given to create().
+	IBinding *find(const BindingPath &path) const { return registry_.find(path); }
+
+	template<typename BindingT>
+	BindingT *find(const BindingPath &path) const
+	{
+		IBinding *binding = registry_.find(path);
+		return binding && binding->getType() == type_tag<BindingT>()
+			? static_cast<BindingT *>(binding)
+			: nullptr;
+	}
+
+	// Goes through Binding::set(), so the edit is undoable like one made in a view.
+	// False if there is no such path or the value type differs, e.g. double for float.
+	template<typename T>
+	bool set(const BindingPath &path, const T &value)
+	{
+		IBinding *binding = registry_.find(path);
+		if (!binding || binding->getValueType() != type_tag<T>())
+		{
+			return false;
+		}
+
+		binding->setValue(&value);
+		return true;
+	}
+
+	template<typename T>
+	bool get(const BindingPath &path, T &value) const
+	{
+		const IBinding *binding = registry_.find(path);
+		if (!binding || binding->getValueType() != type_tag<T>())
+		{
+			return false;
+		}
+
+		binding->getValue(&value);
+		return true;
+	}
+
+	// Thread-safe. The value is written on the next update(), only the last value
+	// posted for a binding during a frame is written.
+	template<typename Model>
+	void post(Binding<Model> *binding, const typename Model::Value &value, bool undoable = true)
+	{
+		writes_.post(new BindingWrite<Binding<Model>>(binding, value, undoable));
+	}
+
+	// Applies posted writes, then refreshes dirty and polled bindings only.
 	void update()
+	{
+		TRACE_SCOPE("Binder::update");
+		writes_.apply();
+		queue_.update(pool_);
+	}
+
+	// Evaluates thread-safe getters on the pool during update(), nullptr keeps
+	// everything on the main thread. The pool must outlive the binder.
+	void setThreadPool(ThreadPool *pool) { pool_ = pool; }
+	ThreadPool *getThreadPool() const { return pool_; }
+
+	// see UpdateQueue
+	void setOffscreenBudget(int64_t budget) { queue_.setOffscreenBudget(budget); }
+	void setHidden(bool hidden) { queue_.setHidden(hidden); }
+
+	// Forces a refresh of every binding, e.g. after the instance has been replaced.
+	void invalidateAll()
+	{
+		for (const auto &binding : bindings_)
+		{
+			binding->invalidate();
+		}
+	}
+
+	const Unigine::Vector<IBinding *> &getBindings() const { return bindings_; }
+
+	// Destroys all bindings at once, e.g. when the world is unloaded. Writes not
+	// applied yet are dropped, the undo history still applies to the instances.
+	void clear()
+	{
+		writes_.discard();
+		queue_.clear();
+		registry_.clear();
+		bindings_.clear();
+		arena_.clear();
+	}
+
+#if BINDS_PROFILE
+	BindingStats getStats() const
+	{
+		BindingStats stats;
+		for (const auto &binding : bindings_)
+		{
+			stats += binding->getStats();
+		}
+		return stats;
+	}
+
+	void resetStats()
 	{
 		for (const auto &binding : bindings_)
 		{
-			binding->update();
+			binding->resetStats();
 		}
 	}
+#endif
 
 private:
 	UndoStack &undo_stack_;
-	InstanceGetter instance_getter_;
+	Source source_;
+	// declared before anything referring to the bindings, so it is destroyed last
+	Arena arena_;
 	Unigine::Vector<IBinding *> bindings_;
+	BindingRegistry registry_;
+	UpdateQueue queue_;
+	WriteQueue writes_;
+	ThreadPool *pool_{};
 };
 
 }
@@ -2,7 +2,48 @@
 
 #include <UnigineMathLib.h>
 
+#include <cassert>
+#include <charconv>
+
 bool compare(float l, float r)
 {
 	return Unigine::Math::compare(l, r);
 }
+
+int format_number(char *buffer, int size, double value, int precision)
+{
+	assert(size > 0);
+
+	const auto result = std::to_chars(buffer, buffer + size - 1, value, std::chars_format::fixed,
+		precision);
+
+	if (result.ec != std::errc())
+	{
+		buffer[0] = '\0';
+		return 0;
+	}
+
+	*result.ptr = '\0';
+	return static_cast<int>(result.ptr - buffer);
+}
+
+bool parse_number(const char *str, double &value)
+{
+	while (*str == ' ' || *str == '\t')
+	{
+		++str;
+	}
+
+	if (*str == '+')
+	{
+		++str;
+	}
+
+	const char *end = str;
+	while (*end != '\0')
+	{
+		++end;
+	}
+
+	return std::from_chars(str, end, value).ec == std::errc();
+}
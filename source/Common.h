@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 
 template<typename T>
 bool compare(const T &l, const T &r)
@@ -9,3 +10,26 @@ bool compare(const T &l, const T &r)
 
 bool compare(float l, float r);
 
+// Stack buffer friendly number conversions, they never allocate.
+// format_number writes a null-terminated fixed-point string and returns its length.
+int format_number(char *buffer, int size, double value, int precision);
+bool parse_number(const char *str, double &value);
+
+// unique address per type, a lightweight stand-in for RTTI
+template<typename T>
+const void *type_tag()
+{
+	static const char tag = 0;
+	return &tag;
+}
+
+// FNV-1a, usable at compile time for string keys
+constexpr uint32_t hash_string(const char *str)
+{
+	uint32_t hash = 2166136261u;
+	while (*str)
+	{
+		hash = (hash ^ static_cast<unsigned char>(*str++)) * 16777619u;
+	}
+	return hash;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <type_traits>
 #include <tuple>
 
@@ -12,6 +13,15 @@ constexpr auto function_pointer(Ret (Class::*)(Args...) const) -> Ret (*)(Args..
 template<auto Func>
 using function_signature = std::remove_pointer_t<decltype(function_pointer(Func))>;
 
+template<typename Class, typename Ret, typename... Args>
+constexpr auto member_class(Ret (Class::*)(Args...)) -> Class *;
+
+template<typename Class, typename Ret, typename... Args>
+constexpr auto member_class(Ret (Class::*)(Args...) const) -> Class *;
+
+template<auto Func>
+using member_class_t = std::remove_pointer_t<decltype(member_class(Func))>;
+
 template<typename T>
 struct function_traits;
 
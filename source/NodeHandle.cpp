@@ -0,0 +1,9 @@
+#include "NodeHandle.h"
+
+namespace binds
+{
+
+// starts past the epoch of unresolved handles
+uint32_t NodeEpoch::epoch_ = 1;
+
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <UnigineNode.h>
+#include <UniginePtr.h>
+#include <UnigineVector.h>
+#include <UnigineWorld.h>
+
+#include <cstdint>
+
+namespace binds
+{
+
+// Counts world changes. Nodes resolved by handles are cached for the epoch they were
+// resolved in, so advance it when the world is loaded or unloaded, see AppWorldLogic.
+// A single deleted node is dropped by the handles that refer to it, see NodeHandle.
+class NodeEpoch
+{
+public:
+	static uint32_t get() { return epoch_; }
+	static void advance() { ++epoch_; }
+
+private:
+	static uint32_t epoch_;
+};
+
+// Refers to a node by its id, which survives world reloads. Within an epoch get() is
+// a compare with the cached epoch and a check that the cached node isn't deleted, the
+// engine lookup runs once after the world changes. A deleted node or a node of another
+// type resolves to nullptr. Resolve on the main thread, the engine lookup isn't
+// thread-safe.
+template<typename NodeT>
+class NodeHandle
+{
+public:
+	NodeHandle() = default;
+
+	explicit NodeHandle(int id)
+		: id_(id)
+	{}
+
+	// The id is looked up by name once per epoch until the node is found, a node created
+	// under the name later is found after the next world change. The name must outlive
+	// the handle.
+	explicit NodeHandle(const char *name)
+		: name_(name)
+	{}
+
+	NodeT *get() const
+	{
+		if (epoch_ != NodeEpoch::get() || (!node_.isNull() && node_.isDeleted()))
+		{
+			resolve();
+		}
+		return node_.get();
+	}
+
+	int getID() const { return id_; }
+	bool isNull() const { return get() == nullptr; }
+
+	bool operator==(const NodeHandle &other) const { return id_ == other.id_ && name_ == other.name_; }
+	bool operator!=(const NodeHandle &other) const { return !(*this == other); }
+
+private:
+	void resolve() const
+	{
+		epoch_ = NodeEpoch::get();
+		node_.clear();
+
+		if (id_ < 0 && name_)
+		{
+			Unigine::NodePtr node = Unigine::World::getNodeByName(name_);
+			if (node.isNull())
+			{
+				return;
+			}
+			id_ = node->getID();
+		}
+
+		if (id_ >= 0)
+		{
+			node_ = Unigine::checked_ptr_cast<NodeT>(Unigine::World::getNodeByID(id_));
+			if (!node_.isNull() && node_.isDeleted())
+			{
+				node_.clear();
+			}
+		}
+	}
+
+	mutable int id_{-1};
+	const char *name_{};
+	// valid in the epoch it was resolved in while it isn't deleted
+	mutable Unigine::Ptr<NodeT> node_;
+	mutable uint32_t epoch_{0};
+};
+
+// Follows a node handle owned by the caller, undo commands keep a copy of the handle
+// rather than a pointer, so they outlive the node and world reloads.
+template<typename NodeT>
+class NodeInstance
+{
+public:
+	using Instance = NodeT;
+	using Ref = NodeHandle<NodeT>;
+
+	NodeInstance(const NodeHandle<NodeT> &handle)
+		: handle_(&handle)
+	{}
+
+	NodeT *operator()() const { return handle_->get(); }
+	const Ref &getRef() const { return *handle_; }
+
+private:
+	const NodeHandle<NodeT> *handle_{};
+};
+
+// Follows a selection of node handles owned by the caller.
+template<typename NodeT>
+class NodeSelection
+{
+public:
+	using Instance = NodeT;
+	using Ref = NodeHandle<NodeT>;
+
+	NodeSelection(const Unigine::Vector<NodeHandle<NodeT>> &selection)
+		: selection_(&selection)
+	{}
+
+	int size() const { return selection_->size(); }
+	NodeT *operator[](int i) const { return selection_->at(i).get(); }
+	const Ref &getRef(int i) const { return selection_->at(i); }
+
+private:
+	const Unigine::Vector<NodeHandle<NodeT>> *selection_{};
+};
+
+}
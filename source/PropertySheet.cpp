@@ -0,0 +1,73 @@
+#include "PropertySheet.h"
+
+#include <cstdio>
+
+namespace binds
+{
+
+PropertyGroup::PropertyGroup(const Unigine::GuiPtr &gui, const char *title)
+	: title_(title)
+{
+	root_ = Unigine::WidgetVBox::create(gui, 0, 5);
+
+	header_ = Unigine::WidgetButton::create(gui, "");
+	clicked_callback_ = header_->addCallback(Unigine::Gui::CLICKED,
+		Unigine::MakeCallback([this]() { setExpanded(!expanded_); }));
+	root_->addChild(header_, Unigine::Gui::ALIGN_EXPAND);
+
+	updateHeader();
+}
+
+PropertyGroup::~PropertyGroup()
+{
+	header_->removeCallback(Unigine::Gui::CLICKED, clicked_callback_);
+}
+
+void PropertyGroup::setExpanded(bool expanded)
+{
+	if (expanded_ == expanded)
+	{
+		return;
+	}
+
+	expanded_ = expanded;
+	updateHeader();
+
+	if (content_.isNull())
+	{
+		// created by update() once on screen
+		return;
+	}
+
+	if (expanded_ || !release_on_collapse_)
+	{
+		content_->setHidden(!expanded_);
+		return;
+	}
+
+	releaseWidgets();
+	root_->removeChild(content_);
+	content_.clear();
+}
+
+void PropertyGroup::update()
+{
+	if (!expanded_ || !content_.isNull() || !is_widget_visible(header_))
+	{
+		return;
+	}
+
+	content_ = Unigine::WidgetGridBox::create(root_->getGui(), 2, 5, 5);
+	content_->setPadding(10, 10, 0, 5);
+	root_->addChild(content_, Unigine::Gui::ALIGN_LEFT);
+	createWidgets(content_);
+}
+
+void PropertyGroup::updateHeader()
+{
+	char text[256];
+	snprintf(text, sizeof(text), "%s %s", expanded_ ? "-" : "+", title_.get());
+	header_->setText(text);
+}
+
+}
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "Bindings.h"
+#include "FunctionTraits.h"
+#include "ValueTraits.h"
+
+#include <UnigineString.h>
+#include <UnigineWidgets.h>
+
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace binds
+{
+
+// A row of a property table. The getter and setter are template arguments, so the
+// bindings generated from the table call them directly.
+template<auto Getter, auto Setter>
+struct Property
+{
+	using Accessor = MemberAccessor<Getter, Setter>;
+	using Value = typename Accessor::Value;
+	using Instance = member_class_t<Getter>;
+
+	const char *path;
+	const char *label;
+	double min;
+	double max;
+	int precision;
+};
+
+template<auto Getter, auto Setter>
+constexpr Property<Getter, Setter> property(const char *path, const char *label, double min = 0.0,
+	double max = 5.0, int precision = 3)
+{
+	return {path, label, min, max, precision};
+}
+
+// Declare the table of a type once, e.g.
+//   constexpr auto DECAL_PROPERTIES = make_property_table(
+//       property<&DecalOrtho::getWidth, &DecalOrtho::setWidth>("decal.width", "Width"), ...);
+template<typename... Properties>
+constexpr std::tuple<Properties...> make_property_table(const Properties &...properties)
+{
+	return std::tuple<Properties...>(properties...);
+}
+
+template<typename BinderT, auto Getter, auto Setter>
+auto create_property_binding(BinderT &binder, const Property<Getter, Setter> &property)
+{
+	auto binding = binder.template create<Getter, Setter>(property.path);
+	binding->setPrecision(property.precision);
+	binding->setRange(property.min, property.max);
+	return binding;
+}
+
+// Creates a binding per property of the table, returns them in table order. The table
+// is unrolled at compile time, every binding is created with its concrete type.
+template<typename BinderT, typename... Properties>
+auto create_property_bindings(BinderT &binder, const std::tuple<Properties...> &table)
+{
+	return std::apply(
+		[&](const auto &...properties) {
+			// braced initialization keeps the table order
+			return std::tuple<decltype(create_property_binding(binder, properties))...>{
+				create_property_binding(binder, properties)...};
+		},
+		table);
+}
+
+// Lays out the label and widgets of a property in two columns of the grid and attaches
+// them to the binding. Returns the widget to detach the binding from, it holds the views.
+template<typename BindingT, auto Getter, auto Setter>
+Unigine::WidgetPtr create_property_widgets(BindingT *binding, const Unigine::WidgetGridBoxPtr &grid,
+	const Property<Getter, Setter> &property)
+{
+	using Value = typename Property<Getter, Setter>::Value;
+	static_assert(std::is_same_v<Value, bool> || is_number_value_v<Value> || is_vector_value_v<Value>,
+		"no widget layout for the value type");
+
+	Unigine::GuiPtr gui = grid->getGui();
+	grid->addChild(Unigine::WidgetLabel::create(gui, property.label), Unigine::Gui::ALIGN_LEFT);
+
+	if constexpr (std::is_same_v<Value, bool>)
+	{
+		auto check_box = Unigine::WidgetCheckBox::create(gui);
+		grid->addChild(check_box, Unigine::Gui::ALIGN_LEFT);
+		binding->attach(check_box);
+		return check_box;
+	}
+	else if constexpr (is_number_value_v<Value>)
+	{
+		auto h_box = Unigine::WidgetHBox::create(gui);
+		h_box->setSpace(5, 0);
+
+		auto edit_line = Unigine::WidgetEditLine::create(gui);
+		auto slider = Unigine::WidgetSlider::create(gui);
+		slider->setWidth(165);
+
+		h_box->addChild(edit_line);
+		h_box->addChild(slider, Unigine::Gui::ALIGN_EXPAND);
+		grid->addChild(h_box, Unigine::Gui::ALIGN_LEFT);
+
+		binding->attach(edit_line);
+		binding->attach(slider);
+		return h_box;
+	}
+	else
+	{
+		auto h_box = Unigine::WidgetHBox::create(gui);
+		h_box->setSpace(5, 0);
+
+		Unigine::Vector<Unigine::WidgetEditLinePtr> fields;
+		for (int i = 0; i < ValueTraits<Value>::size; ++i)
+		{
+			fields.append(Unigine::WidgetEditLine::create(gui));
+			h_box->addChild(fields.last());
+		}
+		grid->addChild(h_box, Unigine::Gui::ALIGN_LEFT);
+
+		binding->attach(fields);
+		return h_box;
+	}
+}
+
+// A collapsible group of a property sheet. The bindings of the group exist from the
+// start, so they track values, can be found by path and replay the journal. The widgets
+// and views are created once the group is expanded and on screen.
+class PropertyGroup
+{
+public:
+	virtual ~PropertyGroup();
+
+	PropertyGroup(const PropertyGroup &) = delete;
+	PropertyGroup &operator=(const PropertyGroup &) = delete;
+
+	void setExpanded(bool expanded);
+	bool isExpanded() const { return expanded_; }
+
+	// Destroys the widgets and views of the group when it is collapsed, they are
+	// created again on the next expand.
+	void setReleaseOnCollapse(bool release) { release_on_collapse_ = release; }
+	bool isReleaseOnCollapse() const { return release_on_collapse_; }
+
+	// Creates the widgets when due, call every frame before Binder::update().
+	void update();
+
+	bool hasWidgets() const { return !content_.isNull(); }
+	Unigine::WidgetPtr getWidget() const { return root_; }
+
+protected:
+	PropertyGroup(const Unigine::GuiPtr &gui, const char *title);
+
+	virtual void createWidgets(const Unigine::WidgetGridBoxPtr &grid) = 0;
+	virtual void releaseWidgets() = 0;
+
+private:
+	void updateHeader();
+
+	Unigine::String title_;
+	Unigine::WidgetVBoxPtr root_;
+	Unigine::WidgetButtonPtr header_;
+	Unigine::WidgetGridBoxPtr content_;
+	void *clicked_callback_{};
+	bool expanded_{false};
+	bool release_on_collapse_{false};
+};
+
+template<typename InstanceT, typename Source, typename... Properties>
+class TablePropertyGroup final : public PropertyGroup
+{
+public:
+	static_assert(sizeof...(Properties) > 0, "empty property group");
+	static_assert((std::is_base_of_v<typename Properties::Instance, InstanceT> && ...),
+		"the table has properties of another type");
+
+	TablePropertyGroup(Binder<InstanceT, Source> &binder, const Unigine::GuiPtr &gui,
+		const char *title, const std::tuple<Properties...> &table)
+		: PropertyGroup(gui, title)
+		, table_(table)
+		, bindings_(create_property_bindings(binder, table))
+	{}
+
+private:
+	using Indices = std::index_sequence_for<Properties...>;
+	using Bindings = decltype(create_property_bindings(std::declval<Binder<InstanceT, Source> &>(),
+		std::declval<const std::tuple<Properties...> &>()));
+
+	void createWidgets(const Unigine::WidgetGridBoxPtr &grid) override { createWidgets(grid, Indices()); }
+	void releaseWidgets() override { releaseWidgets(Indices()); }
+
+	template<size_t... I>
+	void createWidgets(const Unigine::WidgetGridBoxPtr &grid, std::index_sequence<I...>)
+	{
+		((widgets_[I] = create_property_widgets(std::get<I>(bindings_), grid, std::get<I>(table_))), ...);
+	}
+
+	template<size_t... I>
+	void releaseWidgets(std::index_sequence<I...>)
+	{
+		(std::get<I>(bindings_)->detach(widgets_[I]), ...);
+		for (auto &widget : widgets_)
+		{
+			widget.clear();
+		}
+	}
+
+	std::tuple<Properties...> table_;
+	Bindings bindings_;
+	Unigine::WidgetPtr widgets_[sizeof...(Properties)];
+};
+
+// e.g. make_property_group(binder, gui, "Decal", DECAL_PROPERTIES)
+template<typename InstanceT, typename Source, typename... Properties>
+std::unique_ptr<PropertyGroup> make_property_group(Binder<InstanceT, Source> &binder,
+	const Unigine::GuiPtr &gui, const char *title, const std::tuple<Properties...> &table)
+{
+	return std::make_unique<TablePropertyGroup<InstanceT, Source, Properties...>>(binder, gui,
+		title, table);
+}
+
+}
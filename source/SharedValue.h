@@ -0,0 +1,402 @@
+#pragma once
+
+#include "Common.h"
+
+#include <UnigineString.h>
+#include <UnigineVector.h>
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+template<typename E>
+bool compare(const Unigine::Vector<E> &l, const Unigine::Vector<E> &r)
+{
+	if (l.size() != r.size())
+	{
+		return false;
+	}
+
+	for (int i = 0; i < l.size(); ++i)
+	{
+		if (!compare(l[i], r[i]))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+namespace binds
+{
+
+template<typename T>
+size_t value_memory_usage(const T &)
+{
+	return sizeof(T);
+}
+
+template<typename E>
+size_t value_memory_usage(const Unigine::Vector<E> &value)
+{
+	return sizeof(Unigine::Vector<E>) + value.size() * sizeof(E);
+}
+
+inline size_t value_memory_usage(const Unigine::String &value)
+{
+	return sizeof(Unigine::String) + value.size();
+}
+
+// Reference-counted immutable value, copies share one buffer.
+// Not thread-safe, undo history lives on the main thread.
+template<typename T>
+class SharedValue
+{
+public:
+	SharedValue() = default;
+	explicit SharedValue(const T &value)
+		: block_(new Block{1, value})
+		, owner_(true)
+	{}
+
+	SharedValue(const SharedValue &other)
+		: block_(other.block_)
+	{
+		retain();
+	}
+
+	// a copy the buffer is accounted to, e.g. when the value that created it goes away
+	SharedValue(const SharedValue &other, bool owner)
+		: block_(other.block_)
+		, owner_(owner && other.block_)
+	{
+		retain();
+	}
+
+	SharedValue &operator=(const SharedValue &other)
+	{
+		if (block_ != other.block_)
+		{
+			release();
+			block_ = other.block_;
+			owner_ = false;
+			retain();
+		}
+		return *this;
+	}
+
+	SharedValue(SharedValue &&other) noexcept
+		: block_(other.block_)
+		, owner_(other.owner_)
+	{
+		other.block_ = nullptr;
+		other.owner_ = false;
+	}
+
+	SharedValue &operator=(SharedValue &&other) noexcept
+	{
+		if (this != &other)
+		{
+			release();
+			block_ = other.block_;
+			owner_ = other.owner_;
+			other.block_ = nullptr;
+			other.owner_ = false;
+		}
+		return *this;
+	}
+
+	~SharedValue() { release(); }
+
+	bool isNull() const { return block_ == nullptr; }
+	const T &get() const { return block_->value; }
+
+	bool isSame(const SharedValue &other) const { return block_ == other.block_; }
+
+	// the buffer is accounted to the value that created it, copies are free
+	size_t getMemoryUsage() const
+	{
+		return owner_ ? sizeof(Block) - sizeof(T) + value_memory_usage(block_->value) : 0;
+	}
+
+private:
+	struct Block
+	{
+		int refs;
+		T value;
+	};
+
+	void retain()
+	{
+		if (block_)
+		{
+			++block_->refs;
+		}
+	}
+
+	void release()
+	{
+		if (block_ && --block_->refs == 0)
+		{
+			delete block_;
+		}
+		block_ = nullptr;
+	}
+
+	Block *block_{nullptr};
+	bool owner_{false};
+};
+
+// Storage policies for undo values, see ValueStorage. Every storage is built
+// from a value and an optional base storage it may share unchanged data with.
+// A storage rebuilt from another one relative to a base owns what it doesn't
+// share with the base, e.g. when an undo command absorbs a merged one.
+
+// small trivially copyable values are kept inline
+template<typename T>
+class InlineStorage
+{
+public:
+	InlineStorage() = default;
+	InlineStorage(const T &value, const InlineStorage *)
+		: value_(value)
+	{}
+	InlineStorage(const InlineStorage &other, const InlineStorage *)
+		: value_(other.value_)
+	{}
+
+	const T &get() const { return value_; }
+	bool equals(const InlineStorage &other) const { return compare(value_, other.value_); }
+	size_t getMemoryUsage() const { return 0; }
+
+private:
+	T value_{};
+};
+
+// large values are shared whole with the base if they didn't change
+template<typename T>
+class SharedStorage
+{
+public:
+	SharedStorage() = default;
+	SharedStorage(const T &value, const SharedStorage *base)
+	{
+		if (base && !base->value_.isNull() && compare(base->get(), value))
+		{
+			value_ = base->value_;
+		}
+		else
+		{
+			value_ = SharedValue<T>(value);
+		}
+	}
+
+	SharedStorage(const SharedStorage &other, const SharedStorage *base)
+		: value_(other.value_, !base || !base->value_.isSame(other.value_))
+	{}
+
+	const T &get() const { return value_.get(); }
+
+	bool equals(const SharedStorage &other) const
+	{
+		return value_.isSame(other.value_) || compare(get(), other.get());
+	}
+
+	size_t getMemoryUsage() const { return value_.getMemoryUsage(); }
+
+private:
+	SharedValue<T> value_;
+};
+
+// arrays are split into chunks, only the chunks that differ from the base are copied
+// and an unchanged array shares the whole chunk index with the base
+template<typename E>
+class ArrayStorage
+{
+public:
+	using Array = Unigine::Vector<E>;
+
+	ArrayStorage() = default;
+	ArrayStorage(const Array &value, const ArrayStorage *base)
+	{
+		const int num_chunks = (value.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+		const Chunks *base_chunks = base && !base->chunks_.isNull() ? &base->chunks_.get() : nullptr;
+
+		Chunks chunks;
+		chunks.resize(num_chunks);
+
+		int num_shared = 0;
+		Array chunk;
+		for (int i = 0; i < num_chunks; ++i)
+		{
+			const int begin = i * CHUNK_SIZE;
+			const int end = begin + CHUNK_SIZE < value.size() ? begin + CHUNK_SIZE : value.size();
+
+			if (base_chunks && i < base_chunks->size()
+				&& equalRange(base_chunks->at(i).get(), value, begin, end))
+			{
+				chunks[i] = base_chunks->at(i);
+				++num_shared;
+				continue;
+			}
+
+			chunk.clear();
+			for (int j = begin; j < end; ++j)
+			{
+				chunk.append(value[j]);
+			}
+			chunks[i] = SharedValue<Array>(chunk);
+			owned_memory_ += value_memory_usage(chunk);
+		}
+
+		if (base_chunks && num_shared == num_chunks && num_chunks == base_chunks->size())
+		{
+			chunks_ = base->chunks_;
+			return;
+		}
+
+		chunks_ = SharedValue<Chunks>(chunks);
+		owned_memory_ += value_memory_usage(chunks);
+	}
+
+	ArrayStorage(const ArrayStorage &other, const ArrayStorage *base)
+		: chunks_(other.chunks_)
+	{
+		const bool shares_index = base && base->chunks_.isSame(chunks_);
+		if (chunks_.isNull() || shares_index)
+		{
+			return;
+		}
+
+		const Chunks *base_chunks = base && !base->chunks_.isNull() ? &base->chunks_.get() : nullptr;
+		const Chunks &chunks = chunks_.get();
+		for (int i = 0; i < chunks.size(); ++i)
+		{
+			if (!base_chunks || i >= base_chunks->size() || !base_chunks->at(i).isSame(chunks[i]))
+			{
+				owned_memory_ += value_memory_usage(chunks[i].get());
+			}
+		}
+		owned_memory_ += value_memory_usage(chunks);
+	}
+
+	// copies share everything and own nothing
+	ArrayStorage(const ArrayStorage &other)
+		: chunks_(other.chunks_)
+	{}
+
+	ArrayStorage &operator=(const ArrayStorage &other)
+	{
+		chunks_ = other.chunks_;
+		owned_memory_ = 0;
+		return *this;
+	}
+
+	ArrayStorage(ArrayStorage &&other) noexcept
+		: chunks_(std::move(other.chunks_))
+		, owned_memory_(other.owned_memory_)
+	{
+		other.owned_memory_ = 0;
+	}
+
+	ArrayStorage &operator=(ArrayStorage &&other) noexcept
+	{
+		chunks_ = std::move(other.chunks_);
+		owned_memory_ = other.owned_memory_;
+		other.owned_memory_ = 0;
+		return *this;
+	}
+
+	Array get() const
+	{
+		Array value;
+		if (chunks_.isNull())
+		{
+			return value;
+		}
+
+		for (const auto &chunk : chunks_.get())
+		{
+			for (const auto &element : chunk.get())
+			{
+				value.append(element);
+			}
+		}
+		return value;
+	}
+
+	bool equals(const ArrayStorage &other) const
+	{
+		if (chunks_.isSame(other.chunks_))
+		{
+			return true;
+		}
+
+		if (chunks_.isNull() || other.chunks_.isNull())
+		{
+			return false;
+		}
+
+		const Chunks &l = chunks_.get();
+		const Chunks &r = other.chunks_.get();
+		if (l.size() != r.size())
+		{
+			return false;
+		}
+
+		for (int i = 0; i < l.size(); ++i)
+		{
+			if (!l[i].isSame(r[i]) && !compare(l[i].get(), r[i].get()))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	size_t getMemoryUsage() const { return owned_memory_; }
+
+private:
+	using Chunks = Unigine::Vector<SharedValue<Array>>;
+
+	static constexpr int CHUNK_SIZE = sizeof(E) < 4096 ? static_cast<int>(4096 / sizeof(E)) : 1;
+
+	// chunk holds the elements [begin, end) of the array
+	static bool equalRange(const Array &chunk, const Array &value, int begin, int end)
+	{
+		if (chunk.size() != end - begin)
+		{
+			return false;
+		}
+
+		for (int j = begin; j < end; ++j)
+		{
+			if (!compare(chunk[j - begin], value[j]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	SharedValue<Chunks> chunks_;
+	size_t owned_memory_{0};
+};
+
+template<typename T>
+struct StorageFor
+{
+	static constexpr bool is_inline = std::is_trivially_copyable_v<T> && sizeof(T) <= 64;
+	using Type = std::conditional_t<is_inline, InlineStorage<T>, SharedStorage<T>>;
+};
+
+template<typename E>
+struct StorageFor<Unigine::Vector<E>>
+{
+	using Type = ArrayStorage<E>;
+};
+
+template<typename T>
+using ValueStorage = typename StorageFor<T>::Type;
+
+}
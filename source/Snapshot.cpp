@@ -0,0 +1,109 @@
+#include "Snapshot.h"
+
+namespace
+{
+
+// a zero run shorter than this costs less as part of a stored run than as a new run
+constexpr size_t MIN_SKIP = 4;
+
+void write_size(Unigine::Vector<unsigned char> &data, size_t value)
+{
+	while (value >= 0x80)
+	{
+		data.append(static_cast<unsigned char>(value | 0x80));
+		value >>= 7;
+	}
+	data.append(static_cast<unsigned char>(value));
+}
+
+size_t read_size(const unsigned char *&data)
+{
+	size_t value = 0;
+	for (int shift = 0;; shift += 7)
+	{
+		const unsigned char byte = *data++;
+		value |= static_cast<size_t>(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+		{
+			return value;
+		}
+	}
+}
+
+}
+
+namespace binds
+{
+
+// runs of (skipped size, stored size, stored bytes)
+void XorDelta::encode(const unsigned char *from, const unsigned char *to, size_t size)
+{
+	data_.clear();
+
+	size_t offset = 0;
+	while (offset < size)
+	{
+		const size_t start = offset;
+		while (offset < size && from[offset] == to[offset])
+		{
+			++offset;
+		}
+		if (offset == size)
+		{
+			break;
+		}
+		const size_t skip = offset - start;
+
+		// the run goes on over short zero gaps
+		size_t end = offset;
+		size_t zeros = 0;
+		while (end < size && zeros < MIN_SKIP)
+		{
+			zeros = from[end] == to[end] ? zeros + 1 : 0;
+			++end;
+		}
+		end -= zeros;
+
+		write_size(data_, skip);
+		write_size(data_, end - offset);
+		for (; offset < end; ++offset)
+		{
+			data_.append(from[offset] ^ to[offset]);
+		}
+	}
+}
+
+void XorDelta::apply(unsigned char *block) const
+{
+	const unsigned char *data = data_.get();
+	const unsigned char *data_end = data + data_.size();
+	while (data < data_end)
+	{
+		block += read_size(data);
+		for (size_t size = read_size(data); size > 0; --size)
+		{
+			*block++ ^= *data++;
+		}
+	}
+}
+
+uint32_t XorDelta::hashChanged(const unsigned char *block) const
+{
+	uint32_t hash = 2166136261u;
+
+	const unsigned char *data = data_.get();
+	const unsigned char *data_end = data + data_.size();
+	while (data < data_end)
+	{
+		block += read_size(data);
+		const size_t size = read_size(data);
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash = (hash ^ *block++) * 16777619u;
+		}
+		data += size;
+	}
+	return hash;
+}
+
+}
@@ -0,0 +1,352 @@
+#pragma once
+
+#include "Bindings.h"
+#include "UndoJournal.h"
+#include "UndoStack.h"
+#include "ValueTraits.h"
+
+#include <UnigineLog.h>
+#include <UnigineVector.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace binds
+{
+
+// XOR of two blocks of the same size, run-length coded: unchanged bytes are skipped,
+// the changed ones are stored as is. XOR is its own inverse, so one delta turns either
+// block into the other.
+class XorDelta
+{
+public:
+	void encode(const unsigned char *from, const unsigned char *to, size_t size);
+	void apply(unsigned char *block) const;
+
+	// FNV-1a of the bytes the delta changes, tells whether a block is the one expected
+	uint32_t hashChanged(const unsigned char *block) const;
+
+	bool isEmpty() const { return data_.empty(); }
+	size_t getMemoryUsage() const { return sizeof(XorDelta) + data_.size(); }
+
+private:
+	Unigine::Vector<unsigned char> data_;
+};
+
+// Bound state of instances packed property after property, instance after instance.
+// Values are stored component-wise, so padding never shows up as a change. A null
+// instance keeps its place in the block, its fields are zeros and aren't restored.
+template<typename InstanceT, typename... Properties>
+struct SnapshotLayout
+{
+	template<typename PropertyT>
+	using Traits = ValueTraits<typename PropertyT::Value>;
+
+	template<typename PropertyT>
+	static constexpr size_t field_size =
+		Traits<PropertyT>::size * sizeof(typename Traits<PropertyT>::Component);
+
+	static_assert((std::is_arithmetic_v<typename Traits<Properties>::Component> && ...),
+		"snapshots hold numbers, booleans and vectors");
+
+	static constexpr size_t stride = (field_size<Properties> + ...);
+
+	static void capture(const Unigine::Vector<InstanceT *> &instances,
+		Unigine::Vector<unsigned char> &block)
+	{
+		block.resize(static_cast<int>(instances.size() * stride));
+		unsigned char *data = block.get();
+		for (const auto &instance : instances)
+		{
+			if (instance)
+			{
+				(store<Properties>(instance, data), ...);
+			}
+			else
+			{
+				memset(data, 0, stride);
+				data += stride;
+			}
+		}
+	}
+
+	// calls the setters of the fields that differ between the blocks
+	static void restore(const Unigine::Vector<InstanceT *> &instances, const unsigned char *current,
+		const unsigned char *target)
+	{
+		for (const auto &instance : instances)
+		{
+			if (instance)
+			{
+				(load<Properties>(instance, current, target), ...);
+			}
+			else
+			{
+				current += stride;
+				target += stride;
+			}
+		}
+	}
+
+private:
+	template<typename PropertyT>
+	static void store(InstanceT *instance, unsigned char *&data)
+	{
+		using Component = typename Traits<PropertyT>::Component;
+
+		const typename PropertyT::Value value = PropertyT::Accessor::get(instance);
+		for (int i = 0; i < Traits<PropertyT>::size; ++i)
+		{
+			const Component component = Traits<PropertyT>::get(value, i);
+			memcpy(data, &component, sizeof(Component));
+			data += sizeof(Component);
+		}
+	}
+
+	template<typename PropertyT>
+	static void load(InstanceT *instance, const unsigned char *&current, const unsigned char *&target)
+	{
+		using Component = typename Traits<PropertyT>::Component;
+		constexpr size_t size = field_size<PropertyT>;
+
+		if (memcmp(current, target, size) != 0)
+		{
+			typename PropertyT::Value value{};
+			for (int i = 0; i < Traits<PropertyT>::size; ++i)
+			{
+				Component component;
+				memcpy(&component, target + i * sizeof(Component), sizeof(Component));
+				Traits<PropertyT>::set(value, i, component);
+			}
+			PropertyT::Accessor::set(instance, value);
+		}
+
+		current += size;
+		target += size;
+	}
+};
+
+// One undo step for a bulk edit of many instances, e.g. applying a preset. It holds
+// the difference between the states before and after the edit rather than a command
+// per property, and undo and redo write the changed fields in one pass. Instances are
+// kept as Refs, see InstanceRef and NodeHandle, the ones that don't resolve are skipped.
+// The journal records only that a snapshot was pushed, the refs don't outlive the
+// session, so a replayed history has a placeholder in its place that does nothing.
+template<typename Ref, typename... Properties>
+class SnapshotCommand final : public UndoCommand
+{
+public:
+	using InstanceT = std::remove_pointer_t<decltype(std::declval<const Ref &>().get())>;
+	using Layout = SnapshotLayout<InstanceT, Properties...>;
+
+	// the edit is already applied
+	SnapshotCommand(const Unigine::Vector<Ref> &refs, const Unigine::Vector<unsigned char> &before,
+		const Unigine::Vector<unsigned char> &after, const Unigine::Vector<ArenaHandle<IBinding>> &bindings)
+		: refs_(refs)
+		, bindings_(bindings)
+	{
+		delta_.encode(before.get(), after.get(), after.size());
+		before_hash_ = delta_.hashChanged(before.get());
+		after_hash_ = delta_.hashChanged(after.get());
+	}
+
+	bool hasModifications() const { return !delta_.isEmpty(); }
+
+	uint32_t getJournalType() const override { return UndoJournal::TYPE_SNAPSHOT; }
+
+	size_t getMemoryUsage() const override
+	{
+		return sizeof(SnapshotCommand) + delta_.getMemoryUsage() + refs_.size() * sizeof(Ref)
+			+ bindings_.size() * sizeof(ArenaHandle<IBinding>);
+	}
+
+	void redo() override
+	{
+		if (!applied_)
+		{
+			applied_ = apply(before_hash_);
+		}
+	}
+
+	void undo() override
+	{
+		if (applied_)
+		{
+			applied_ = !apply(after_hash_);
+		}
+	}
+
+private:
+	// The delta flips the current state into the other one, so the instances must
+	// hold the state the command left. The check needs every instance, the ones that
+	// resolve are written regardless once some are gone.
+	bool apply(uint32_t expected_hash)
+	{
+		TRACE_SCOPE("SnapshotCommand::apply");
+
+		Unigine::Vector<InstanceT *> instances;
+		instances.resize(refs_.size());
+		bool resolved = true;
+		for (int i = 0; i < refs_.size(); ++i)
+		{
+			instances[i] = refs_[i].get();
+			resolved = resolved && instances[i];
+		}
+
+		Unigine::Vector<unsigned char> current;
+		Layout::capture(instances, current);
+		if (resolved && delta_.hashChanged(current.get()) != expected_hash)
+		{
+			Unigine::Log::error(
+				"SnapshotCommand::apply(): the instances were changed outside of the history\n");
+			return false;
+		}
+
+		Unigine::Vector<unsigned char> target(current);
+		delta_.apply(target.get());
+		Layout::restore(instances, current.get(), target.get());
+
+		for (const auto &handle : bindings_)
+		{
+			if (IBinding *binding = handle.get())
+			{
+				binding->invalidate();
+			}
+		}
+		return true;
+	}
+
+	Unigine::Vector<Ref> refs_;
+	Unigine::Vector<ArenaHandle<IBinding>> bindings_;
+	XorDelta delta_;
+	uint32_t before_hash_{0};
+	uint32_t after_hash_{0};
+	bool applied_{true};
+};
+
+// Records the edits made to the instances during its lifetime as one snapshot command,
+// e.g.
+//   auto snapshot = make_snapshot_scope(undo_stack, DECAL_PROPERTIES, decals);
+//   apply_preset(decals);
+// Only the properties of the table are captured, edit them through the instances
+// directly rather than through bindings.
+template<typename Ref, typename... Properties>
+class SnapshotScope final
+{
+public:
+	using Command = SnapshotCommand<Ref, Properties...>;
+	using InstanceT = typename Command::InstanceT;
+	using Layout = typename Command::Layout;
+
+	SnapshotScope(UndoStack &undo_stack, const std::tuple<Properties...> &table,
+		const Unigine::Vector<Ref> &refs)
+		: undo_stack_(undo_stack)
+		, table_(table)
+		, refs_(refs)
+	{
+		Layout::capture(resolve(), before_);
+	}
+
+	~SnapshotScope() { commit(); }
+
+	SnapshotScope(const SnapshotScope &) = delete;
+	SnapshotScope &operator=(const SnapshotScope &) = delete;
+
+	// The bindings of the binder with the paths of the table are refreshed on commit,
+	// undo and redo.
+	template<typename BinderT>
+	void setBinder(const BinderT &binder)
+	{
+		bindings_.clear();
+		std::apply(
+			[&](const auto &...properties) {
+				(addBinding(binder.find(properties.path)), ...);
+			},
+			table_);
+	}
+
+	// Pushes the changes made so far, false if there are none. Called on destruction.
+	bool commit()
+	{
+		if (committed_)
+		{
+			return false;
+		}
+		committed_ = true;
+
+		Unigine::Vector<unsigned char> after;
+		Layout::capture(resolve(), after);
+
+		auto cmd = undo_stack_.create<Command>(refs_, before_, after, bindings_);
+		if (!cmd->hasModifications())
+		{
+			delete cmd;
+			return false;
+		}
+
+		undo_stack_.push(cmd);
+		for (const auto &handle : bindings_)
+		{
+			if (IBinding *binding = handle.get())
+			{
+				binding->invalidate();
+			}
+		}
+		return true;
+	}
+
+private:
+	const Unigine::Vector<InstanceT *> &resolve()
+	{
+		instances_.resize(refs_.size());
+		for (int i = 0; i < refs_.size(); ++i)
+		{
+			instances_[i] = refs_[i].get();
+		}
+		return instances_;
+	}
+
+	void addBinding(IBinding *binding)
+	{
+		if (binding)
+		{
+			bindings_.append(binding->getHandle());
+		}
+	}
+
+	UndoStack &undo_stack_;
+	std::tuple<Properties...> table_;
+	Unigine::Vector<Ref> refs_;
+	Unigine::Vector<InstanceT *> instances_;
+	Unigine::Vector<ArenaHandle<IBinding>> bindings_;
+	Unigine::Vector<unsigned char> before_;
+	bool committed_{false};
+};
+
+// Instances held by smart pointers must outlive the history, see InstanceRef.
+template<typename InstanceT, typename... Properties>
+SnapshotScope<InstanceRef<InstanceT>, Properties...> make_snapshot_scope(UndoStack &undo_stack,
+	const std::tuple<Properties...> &table, const Unigine::Vector<Unigine::Ptr<InstanceT>> &instances)
+{
+	Unigine::Vector<InstanceRef<InstanceT>> refs;
+	refs.resize(instances.size());
+	for (int i = 0; i < instances.size(); ++i)
+	{
+		refs[i] = instances[i].get();
+	}
+	return SnapshotScope<InstanceRef<InstanceT>, Properties...>(undo_stack, table, refs);
+}
+
+// Refs resolved on undo and redo, e.g. the node handles of a NodeSelection.
+template<typename Ref, typename... Properties>
+SnapshotScope<Ref, Properties...> make_snapshot_scope(UndoStack &undo_stack,
+	const std::tuple<Properties...> &table, const Unigine::Vector<Ref> &refs)
+{
+	return SnapshotScope<Ref, Properties...>(undo_stack, table, refs);
+}
+
+}
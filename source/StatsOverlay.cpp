@@ -0,0 +1,155 @@
+#include "StatsOverlay.h"
+
+#if BINDS_PROFILE
+
+#include "Bindings.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace binds
+{
+
+namespace
+{
+
+const char *COLUMN_TITLES[StatsOverlay::NUM_COLUMNS] = {
+	"binding", "gets", "sets", "writes", "skipped", "time, us"};
+
+double get_column_value(const BindingStats &stats, StatsOverlay::Column column)
+{
+	switch (column)
+	{
+		case StatsOverlay::COLUMN_GETS: return static_cast<double>(stats.num_gets);
+		case StatsOverlay::COLUMN_SETS: return static_cast<double>(stats.num_sets);
+		case StatsOverlay::COLUMN_WRITES: return static_cast<double>(stats.num_widget_writes);
+		case StatsOverlay::COLUMN_SKIPPED: return static_cast<double>(stats.num_skipped_writes);
+		case StatsOverlay::COLUMN_TIME: return static_cast<double>(stats.time_ns) / 1000.0;
+		default: return 0.0;
+	}
+}
+
+const char *get_binding_name(const IBinding *binding)
+{
+	const char *name = binding->getName();
+	return name && *name ? name : "<unnamed>";
+}
+
+}
+
+StatsOverlay::StatsOverlay(const Unigine::GuiPtr &gui, int num_rows)
+	: num_rows_(num_rows)
+{
+	root_ = Unigine::WidgetVBox::create(gui);
+	root_->setSpace(0, 5);
+
+	total_label_ = Unigine::WidgetLabel::create(gui);
+	root_->addChild(total_label_, Unigine::Gui::ALIGN_LEFT);
+
+	auto grid = Unigine::WidgetGridBox::create(gui, NUM_COLUMNS, 10, 2);
+	for (int i = 0; i < NUM_COLUMNS; ++i)
+	{
+		headers_[i] = Unigine::WidgetButton::create(gui, COLUMN_TITLES[i]);
+		header_callbacks_[i] = headers_[i]->addCallback(Unigine::Gui::CLICKED,
+			Unigine::MakeCallback([this, i]() { setSortColumn(static_cast<Column>(i)); }));
+		grid->addChild(headers_[i], Unigine::Gui::ALIGN_EXPAND);
+	}
+
+	cells_.resize(num_rows_ * NUM_COLUMNS);
+	for (int i = 0; i < cells_.size(); ++i)
+	{
+		cells_[i] = Unigine::WidgetLabel::create(gui);
+		const bool is_name = i % NUM_COLUMNS == COLUMN_NAME;
+		grid->addChild(cells_[i], is_name ? Unigine::Gui::ALIGN_LEFT : Unigine::Gui::ALIGN_RIGHT);
+	}
+
+	root_->addChild(grid, Unigine::Gui::ALIGN_LEFT);
+}
+
+StatsOverlay::~StatsOverlay()
+{
+	for (int i = 0; i < NUM_COLUMNS; ++i)
+	{
+		headers_[i]->removeCallback(Unigine::Gui::CLICKED, header_callbacks_[i]);
+	}
+}
+
+void StatsOverlay::setSortColumn(Column column)
+{
+	sort_column_ = column;
+	// redraw on the next update
+	next_redraw_ = {};
+}
+
+void StatsOverlay::update(const Unigine::Vector<IBinding *> &bindings)
+{
+	const auto now = std::chrono::steady_clock::now();
+	if (now < next_redraw_)
+	{
+		return;
+	}
+
+	next_redraw_ = now + std::chrono::milliseconds(REDRAW_INTERVAL_MS);
+	redraw(bindings);
+}
+
+void StatsOverlay::redraw(const Unigine::Vector<IBinding *> &bindings)
+{
+	BindingStats total;
+	sorted_.resize(bindings.size());
+	for (int i = 0; i < bindings.size(); ++i)
+	{
+		sorted_[i] = bindings[i];
+		total += bindings[i]->getStats();
+	}
+
+	char text[128];
+	char time[32];
+	format_number(time, sizeof(time), static_cast<double>(total.time_ns) / 1e6, 2);
+	snprintf(text, sizeof(text), "%d bindings, %s ms", bindings.size(), time);
+	total_label_->setText(text);
+
+	const Column column = sort_column_;
+	const int num_shown = std::min(num_rows_, sorted_.size());
+	std::partial_sort(sorted_.begin(), sorted_.begin() + num_shown, sorted_.end(),
+		[column](const IBinding *l, const IBinding *r) {
+			if (column == COLUMN_NAME)
+			{
+				return strcmp(get_binding_name(l), get_binding_name(r)) < 0;
+			}
+			return get_column_value(l->getStats(), column) > get_column_value(r->getStats(), column);
+		});
+
+	for (int row = 0; row < num_rows_; ++row)
+	{
+		setRow(row, row < num_shown ? sorted_[row] : nullptr);
+	}
+}
+
+void StatsOverlay::setRow(int row, const IBinding *binding)
+{
+	Unigine::WidgetLabelPtr *cells = cells_.get() + row * NUM_COLUMNS;
+	if (!binding)
+	{
+		for (int i = 0; i < NUM_COLUMNS; ++i)
+		{
+			cells[i]->setText("");
+		}
+		return;
+	}
+
+	cells[COLUMN_NAME]->setText(get_binding_name(binding));
+
+	char text[32];
+	for (int i = COLUMN_NAME + 1; i < NUM_COLUMNS; ++i)
+	{
+		const Column column = static_cast<Column>(i);
+		format_number(text, sizeof(text), get_column_value(binding->getStats(), column),
+			column == COLUMN_TIME ? 1 : 0);
+		cells[i]->setText(text);
+	}
+}
+
+}
+
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "BindingStats.h"
+
+#if BINDS_PROFILE
+
+#include <UnigineVector.h>
+#include <UnigineWidgets.h>
+
+#include <chrono>
+
+namespace binds
+{
+
+class IBinding;
+
+// Table of the most expensive bindings, a click on a column header sorts by that column.
+class StatsOverlay final
+{
+public:
+	enum Column
+	{
+		COLUMN_NAME,
+		COLUMN_GETS,
+		COLUMN_SETS,
+		COLUMN_WRITES,
+		COLUMN_SKIPPED,
+		COLUMN_TIME,
+		NUM_COLUMNS,
+	};
+
+	explicit StatsOverlay(const Unigine::GuiPtr &gui, int num_rows = 10);
+	~StatsOverlay();
+
+	StatsOverlay(const StatsOverlay &) = delete;
+	StatsOverlay &operator=(const StatsOverlay &) = delete;
+
+	// add it to a window or a container
+	Unigine::WidgetPtr getWidget() const { return root_; }
+
+	void setSortColumn(Column column);
+	Column getSortColumn() const { return sort_column_; }
+
+	// Call it every frame, the table is redrawn a few times per second.
+	void update(const Unigine::Vector<IBinding *> &bindings);
+
+private:
+	static constexpr int REDRAW_INTERVAL_MS = 500;
+
+	void redraw(const Unigine::Vector<IBinding *> &bindings);
+	void setRow(int row, const IBinding *binding);
+
+	Unigine::WidgetVBoxPtr root_;
+	Unigine::WidgetLabelPtr total_label_;
+	Unigine::WidgetButtonPtr headers_[NUM_COLUMNS];
+	void *header_callbacks_[NUM_COLUMNS]{};
+	// num_rows_ * NUM_COLUMNS labels, row by row
+	Unigine::Vector<Unigine::WidgetLabelPtr> cells_;
+	int num_rows_{0};
+
+	Unigine::Vector<IBinding *> sorted_;
+	Column sort_column_{COLUMN_TIME};
+	std::chrono::steady_clock::time_point next_redraw_{};
+};
+
+}
+
+#endif
@@ -0,0 +1,202 @@
+#pragma once
+
+#include "Bindings.h"
+
+#include <UnigineVector.h>
+#include <UnigineWidgets.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <type_traits>
+
+namespace binds
+{
+
+// Spreadsheet of instances in rows and properties in columns. Only the rows that fit
+// into the view have widgets and bindings, scrolling points them at other instances,
+// so the cost depends on the height of the view rather than on the number of rows.
+// Cells are bindings of one binder, the rows scrolled in are refreshed in one pass,
+// with a thread pool the getters of thread-safe columns run in parallel.
+template<typename InstanceT>
+class TableView final
+{
+public:
+	using InstancePtr = Unigine::Ptr<InstanceT>;
+	using Rows = Unigine::Vector<InstancePtr>;
+
+	// Follows rows owned by the caller, they may change at any time.
+	TableView(UndoStack &undo_stack, const Unigine::GuiPtr &gui, const Rows &rows,
+		int num_visible_rows = 20)
+		: gui_(gui)
+		, rows_(&rows)
+		, binder_(undo_stack, PtrInstance<InstanceT>(no_instance_))
+	{
+		slots_.resize(num_visible_rows);
+
+		root_ = Unigine::WidgetHBox::create(gui_, 4, 0);
+
+		auto numbers = createColumn("#");
+		for (int i = 0; i < num_visible_rows; ++i)
+		{
+			auto label = Unigine::WidgetLabel::create(gui_, "");
+			label->setHidden(true);
+			numbers->addChild(label, Unigine::Gui::ALIGN_EXPAND);
+			row_labels_.append(label);
+		}
+
+		scroll_ = Unigine::WidgetScroll::create(gui_, 1);
+		scroll_->setFrameSize(num_visible_rows);
+		scroll_->setStepSize(1);
+		root_->addChild(scroll_, Unigine::Gui::ALIGN_EXPAND);
+	}
+
+	TableView(const TableView &) = delete;
+	TableView &operator=(const TableView &) = delete;
+
+	template<auto Getter, auto Setter>
+	void addColumn(const char *title, int precision = 3)
+	{
+		addColumn<MemberAccessor<Getter, Setter>>(title, precision);
+	}
+
+	template<typename Accessor>
+	void addColumn(const char *title, int precision = 3)
+	{
+		using Value = typename Accessor::Value;
+		static_assert(std::is_same_v<Value, bool> || is_number_value_v<Value>,
+			"table cells are edit lines or check boxes");
+
+		auto column = createColumn(title);
+		// the scroll bar stays the last child
+		root_->removeChild(scroll_);
+		root_->addChild(scroll_, Unigine::Gui::ALIGN_EXPAND);
+
+		for (int i = 0; i < slots_.size(); ++i)
+		{
+			Unigine::WidgetPtr cell;
+			if constexpr (std::is_same_v<Value, bool>)
+			{
+				cell = Unigine::WidgetCheckBox::create(gui_, "");
+			}
+			else
+			{
+				cell = Unigine::WidgetEditLine::create(gui_, "");
+			}
+			cell->setHidden(slots_[i].isNull());
+			column->addChild(cell, Unigine::Gui::ALIGN_EXPAND);
+
+			auto binding = binder_.template create<Accessor>(PtrInstance<InstanceT>(slots_[i]));
+			binding->setPrecision(precision);
+			binding->setPolling(true);
+			binding->setRefreshRate(refresh_rate_);
+			binding->attach(cell);
+
+			cells_.append(Cell{cell, binding});
+		}
+		++num_columns_;
+	}
+
+	// Scrolls to the rows changed by the caller, then refreshes the cells.
+	void update()
+	{
+		const int num_rows = rows_->size();
+		const int num_slots = slots_.size();
+		const int max_first_row = std::max(num_rows - num_slots, 0);
+
+		scroll_->setObjectSize(std::max(num_rows, num_slots));
+		first_row_ = std::min(std::max(scroll_->getValue(), 0), max_first_row);
+
+		for (int i = 0; i < num_slots; ++i)
+		{
+			const int row = first_row_ + i;
+			InstanceT *instance = row < num_rows ? rows_->at(row).get() : nullptr;
+			if (slots_[i].get() != instance)
+			{
+				assignSlot(i, row);
+			}
+		}
+
+		binder_.update();
+	}
+
+	void scrollTo(int row) { scroll_->setValue(row); }
+	int getFirstRow() const { return first_row_; }
+	int getNumVisibleRows() const { return slots_.size(); }
+
+	// How often the cells are read back, so changes made elsewhere show up.
+	void setRefreshRate(float hz)
+	{
+		refresh_rate_ = hz;
+		for (const auto &cell : cells_)
+		{
+			cell.binding->setRefreshRate(hz);
+		}
+	}
+
+	void setThreadPool(ThreadPool *pool) { binder_.setThreadPool(pool); }
+
+	Unigine::WidgetPtr getWidget() const { return root_; }
+
+private:
+	struct Cell
+	{
+		Unigine::WidgetPtr widget;
+		IBinding *binding{};
+	};
+
+	Unigine::WidgetVBoxPtr createColumn(const char *title)
+	{
+		auto column = Unigine::WidgetVBox::create(gui_, 0, 2);
+		column->addChild(Unigine::WidgetLabel::create(gui_, title), Unigine::Gui::ALIGN_LEFT);
+		root_->addChild(column, Unigine::Gui::ALIGN_TOP);
+		return column;
+	}
+
+	// Points the widgets of the slot at the row, an edit in progress is committed to
+	// the instance it was started on.
+	void assignSlot(int slot, int row)
+	{
+		for (int column = 0; column < num_columns_; ++column)
+		{
+			const Cell &cell = cells_[column * slots_.size() + slot];
+			if (cell.widget->isFocused())
+			{
+				cell.widget->removeFocus();
+			}
+		}
+
+		const bool has_row = row < rows_->size();
+		slots_[slot] = has_row ? rows_->at(row) : InstancePtr();
+
+		char text[16];
+		snprintf(text, sizeof(text), "%d", row + 1);
+		row_labels_[slot]->setText(text);
+		row_labels_[slot]->setHidden(!has_row);
+
+		for (int column = 0; column < num_columns_; ++column)
+		{
+			const Cell &cell = cells_[column * slots_.size() + slot];
+			cell.widget->setHidden(!has_row);
+			cell.binding->invalidate();
+		}
+	}
+
+	Unigine::GuiPtr gui_;
+	const Rows *rows_{};
+	// source of the binder, every cell has the source of its slot instead
+	InstancePtr no_instance_;
+	// instances shown by the widget rows, the size is fixed so cells can follow them
+	Rows slots_;
+	Binder<InstanceT> binder_;
+
+	Unigine::WidgetHBoxPtr root_;
+	Unigine::WidgetScrollPtr scroll_;
+	Unigine::Vector<Unigine::WidgetLabelPtr> row_labels_;
+	// column-major, one per slot of every column
+	Unigine::Vector<Cell> cells_;
+	int num_columns_{0};
+	int first_row_{0};
+	float refresh_rate_{10.0f};
+};
+
+}
@@ -0,0 +1,180 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(int num_threads)
+{
+	if (num_threads < 0)
+	{
+		num_threads = std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+	}
+
+	num_slices_ = num_threads + 1;
+	slices_ = std::make_unique<Slice[]>(num_slices_);
+
+	threads_.reserve(num_threads);
+	for (int i = 0; i < num_threads; ++i)
+	{
+		threads_.emplace_back(&ThreadPool::workerLoop, this, i + 1);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	wake_.notify_all();
+
+	for (auto &thread : threads_)
+	{
+		thread.join();
+	}
+}
+
+void ThreadPool::parallelFor(int count, int grain, const Task &task)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	grain = std::max(grain, 1);
+	if (threads_.empty() || count <= grain)
+	{
+		task(0, count);
+		return;
+	}
+
+	// even split, stealing evens out the chunks that turn out slower
+	for (int i = 0; i < num_slices_; ++i)
+	{
+		Slice &slice = slices_[i];
+		std::lock_guard<std::mutex> lock(slice.mutex);
+		slice.begin = static_cast<int>(int64_t(count) * i / num_slices_);
+		slice.end = static_cast<int>(int64_t(count) * (i + 1) / num_slices_);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		task_ = &task;
+		grain_ = grain;
+		num_active_ = getNumThreads();
+		++generation_;
+	}
+	wake_.notify_all();
+
+	run(0);
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	done_.wait(lock, [this] { return num_active_ == 0; });
+	task_ = nullptr;
+}
+
+void ThreadPool::workerLoop(int slot)
+{
+	uint64_t generation = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			wake_.wait(lock, [&] { return stop_ || generation_ != generation; });
+			if (stop_)
+			{
+				return;
+			}
+			generation = generation_;
+		}
+
+		run(slot);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (--num_active_ == 0)
+		{
+			done_.notify_one();
+		}
+	}
+}
+
+void ThreadPool::run(int slot)
+{
+	int begin = 0;
+	int end = 0;
+	while (take(slot, begin, end) || steal(slot, begin, end))
+	{
+		(*task_)(begin, end);
+	}
+}
+
+bool ThreadPool::take(int slot, int &begin, int &end)
+{
+	Slice &slice = slices_[slot];
+	std::lock_guard<std::mutex> lock(slice.mutex);
+	if (slice.begin >= slice.end)
+	{
+		return false;
+	}
+
+	begin = slice.begin;
+	end = std::min(slice.begin + grain_, slice.end);
+	slice.begin = end;
+	return true;
+}
+
+bool ThreadPool::steal(int slot, int &begin, int &end)
+{
+	for (;;)
+	{
+		int victim = -1;
+		int largest = 0;
+		for (int i = 0; i < num_slices_; ++i)
+		{
+			if (i == slot)
+			{
+				continue;
+			}
+
+			Slice &slice = slices_[i];
+			std::lock_guard<std::mutex> lock(slice.mutex);
+			if (slice.end - slice.begin > largest)
+			{
+				largest = slice.end - slice.begin;
+				victim = i;
+			}
+		}
+
+		if (victim < 0)
+		{
+			return false;
+		}
+
+		{
+			Slice &slice = slices_[victim];
+			std::lock_guard<std::mutex> lock(slice.mutex);
+			const int size = slice.end - slice.begin;
+			if (size <= 0)
+			{
+				// drained meanwhile, look again
+				continue;
+			}
+
+			// the back half, the owner keeps taking from the front
+			const int half = size > grain_ ? size / 2 : size;
+			begin = slice.end - half;
+			end = slice.end;
+			slice.end = begin;
+		}
+
+		// run the first chunk right away and make the rest stealable
+		if (end - begin > grain_)
+		{
+			Slice &own = slices_[slot];
+			std::lock_guard<std::mutex> lock(own.mutex);
+			own.begin = begin + grain_;
+			own.end = end;
+			end = own.begin;
+		}
+		return true;
+	}
+}
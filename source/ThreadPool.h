@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fork-join pool for data-parallel loops. Every participant owns a slice of the range and
+// takes chunks from its front, an idle participant steals half of the largest slice left.
+class ThreadPool final
+{
+public:
+	using Task = std::function<void(int begin, int end)>;
+
+	// a negative count uses one thread less than the hardware has, the caller is the last one
+	explicit ThreadPool(int num_threads = -1);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	int getNumThreads() const { return static_cast<int>(threads_.size()); }
+
+	// Calls the task on chunks of [0, count) of at most grain items and returns once
+	// all of them are done. The calling thread takes part, calls must not be nested.
+	void parallelFor(int count, int grain, const Task &task);
+
+private:
+	struct Slice
+	{
+		std::mutex mutex;
+		int begin{0};
+		int end{0};
+	};
+
+	void workerLoop(int slot);
+	void run(int slot);
+	bool take(int slot, int &begin, int &end);
+	bool steal(int slot, int &begin, int &end);
+
+	std::vector<std::thread> threads_;
+	std::unique_ptr<Slice[]> slices_;
+	int num_slices_{1};
+
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::condition_variable done_;
+	const Task *task_{};
+	int grain_{1};
+	uint64_t generation_{0};
+	int num_active_{0};
+	bool stop_{false};
+};
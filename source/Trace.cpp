@@ -0,0 +1,180 @@
+#include "Trace.h"
+
+#include <UnigineLog.h>
+#include <UnigineVector.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+namespace
+{
+
+struct Event
+{
+	static constexpr size_t ARG_SIZE = 40;
+
+	const char *name;
+	int64_t start;
+	int64_t duration;
+	char arg[ARG_SIZE];
+};
+
+// Written by its thread only, dump() reads it concurrently and drops what
+// may have been overwritten while it was copied.
+struct ThreadBuffer
+{
+	static constexpr uint64_t CAPACITY = 1 << 14;
+
+	Event events[CAPACITY];
+	std::atomic<uint64_t> head{0};
+	// events before it were cleared
+	std::atomic<uint64_t> tail{0};
+	int tid{0};
+};
+
+std::mutex buffers_mutex;
+Unigine::Vector<ThreadBuffer *> buffers;
+thread_local ThreadBuffer *thread_buffer = nullptr;
+
+const auto start_time = std::chrono::steady_clock::now();
+
+ThreadBuffer *get_thread_buffer()
+{
+	if (!thread_buffer)
+	{
+		// buffers outlive their threads, the events of finished threads are still dumped
+		auto buffer = new ThreadBuffer();
+		std::lock_guard<std::mutex> lock(buffers_mutex);
+		buffer->tid = buffers.size() + 1;
+		buffers.append(buffer);
+		thread_buffer = buffer;
+	}
+	return thread_buffer;
+}
+
+void write_string(FILE *file, const char *str)
+{
+	fputc('"', file);
+	for (; *str; ++str)
+	{
+		const unsigned char c = static_cast<unsigned char>(*str);
+		if (c == '"' || c == '\\')
+		{
+			fputc('\\', file);
+			fputc(c, file);
+		}
+		else if (c < 0x20)
+		{
+			fprintf(file, "\\u%04x", c);
+		}
+		else
+		{
+			fputc(c, file);
+		}
+	}
+	fputc('"', file);
+}
+
+}
+
+std::atomic<bool> Trace::enabled_{false};
+
+int64_t Trace::now()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now() - start_time).count();
+}
+
+void Trace::record(const char *name, const char *arg, int64_t start, int64_t duration)
+{
+	ThreadBuffer *buffer = get_thread_buffer();
+	const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+	Event &event = buffer->events[head % ThreadBuffer::CAPACITY];
+	event.name = name;
+	event.start = start;
+	event.duration = duration;
+	if (arg)
+	{
+		strncpy(event.arg, arg, Event::ARG_SIZE - 1);
+		event.arg[Event::ARG_SIZE - 1] = '\0';
+	}
+	else
+	{
+		event.arg[0] = '\0';
+	}
+	buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void Trace::clear()
+{
+	std::lock_guard<std::mutex> lock(buffers_mutex);
+	for (const auto &buffer : buffers)
+	{
+		buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+	}
+}
+
+bool Trace::dump(const char *path)
+{
+	FILE *file = fopen(path, "wb");
+	if (!file)
+	{
+		Unigine::Log::error("Trace::dump(): can't open \"%s\"\n", path);
+		return false;
+	}
+
+	fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", file);
+	bool first = true;
+
+	std::lock_guard<std::mutex> lock(buffers_mutex);
+	auto copy = std::make_unique<Event[]>(ThreadBuffer::CAPACITY);
+	for (const auto &buffer : buffers)
+	{
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+			"\"args\":{\"name\":\"thread %d\"}}", first ? "" : ",\n", buffer->tid, buffer->tid);
+		first = false;
+
+		const uint64_t head = buffer->head.load(std::memory_order_acquire);
+		uint64_t begin = head > ThreadBuffer::CAPACITY ? head - ThreadBuffer::CAPACITY : 0;
+		begin = std::max(begin, buffer->tail.load(std::memory_order_relaxed));
+		for (uint64_t i = begin; i < head; ++i)
+		{
+			copy[i - begin] = buffer->events[i % ThreadBuffer::CAPACITY];
+		}
+
+		// the owner may have overwritten the oldest events while they were copied, and
+		// may be writing the slot of the event at new_head - CAPACITY
+		const uint64_t new_head = buffer->head.load(std::memory_order_acquire);
+		const uint64_t valid =
+			new_head >= ThreadBuffer::CAPACITY ? new_head - ThreadBuffer::CAPACITY + 1 : 0;
+
+		for (uint64_t i = std::max(begin, valid); i < head; ++i)
+		{
+			const Event &event = copy[i - begin];
+			fputs(",\n{\"name\":", file);
+			write_string(file, event.name);
+			fprintf(file, ",\"cat\":\"binds\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+				buffer->tid, event.start / 1000.0, event.duration / 1000.0);
+			if (event.arg[0])
+			{
+				fputs(",\"args\":{\"binding\":", file);
+				write_string(file, event.arg);
+				fputc('}', file);
+			}
+			fputc('}', file);
+		}
+	}
+
+	fputs("]}\n", file);
+	const bool ok = !ferror(file);
+	fclose(file);
+	if (!ok)
+	{
+		Unigine::Log::error("Trace::dump(): can't write \"%s\"\n", path);
+	}
+	return ok;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Flight recorder of scoped events. Every thread writes into its own ring buffer
+// without locks, so only the latest events are kept; dump() writes them in the
+// Chrome/Perfetto JSON trace format (chrome://tracing, ui.perfetto.dev).
+class Trace final
+{
+public:
+	static void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+	static bool isEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+	// Names are not copied and must stay valid until the dump, use string literals.
+	// Arguments are copied, long ones are truncated.
+	static void record(const char *name, const char *arg, int64_t start, int64_t duration);
+
+	// Thread-safe, events recorded meanwhile may be missing from the dump.
+	static bool dump(const char *path);
+	// drops the events recorded so far
+	static void clear();
+
+	// nanoseconds
+	static int64_t now();
+
+private:
+	static std::atomic<bool> enabled_;
+};
+
+class TraceScope final
+{
+public:
+	explicit TraceScope(const char *name, const char *arg = nullptr)
+		: name_(name)
+		, arg_(arg)
+		, start_(Trace::isEnabled() ? Trace::now() : -1)
+	{}
+
+	~TraceScope()
+	{
+		if (start_ >= 0)
+		{
+			Trace::record(name_, arg_, start_, Trace::now() - start_);
+		}
+	}
+
+	TraceScope(const TraceScope &) = delete;
+	TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+	const char *name_;
+	const char *arg_;
+	int64_t start_;
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+// TRACE_SCOPE(name) or TRACE_SCOPE(name, arg), traces until the end of the scope
+#define TRACE_SCOPE(...) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(__VA_ARGS__)
@@ -0,0 +1,414 @@
+#include "UndoJournal.h"
+#include "UndoStack.h"
+
+#include <UnigineLog.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+const char MAGIC[4] = {'O', 'A', 'U', 'J'};
+const uint32_t VERSION = 2;
+const size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(VERSION);
+const int MAX_BUFFER_SIZE = 64 * 1024;
+
+// keeps history positions in sync for commands that can't be restored
+class UndoPlaceholder final : public UndoCommand
+{
+public:
+	void undo() override {}
+	void redo() override {}
+};
+
+class MappedFile final
+{
+public:
+	explicit MappedFile(const char *path)
+	{
+#ifdef _WIN32
+		file_ = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file_ == INVALID_HANDLE_VALUE)
+		{
+			return;
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0)
+		{
+			return;
+		}
+
+		mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping_)
+		{
+			data_ = static_cast<const unsigned char *>(
+				MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+			size_ = data_ ? static_cast<size_t>(size.QuadPart) : 0;
+		}
+#else
+		fd_ = ::open(path, O_RDONLY);
+		if (fd_ < 0)
+		{
+			return;
+		}
+
+		struct stat st;
+		if (fstat(fd_, &st) != 0 || st.st_size == 0)
+		{
+			return;
+		}
+
+		void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd_, 0);
+		if (data != MAP_FAILED)
+		{
+			data_ = static_cast<const unsigned char *>(data);
+			size_ = st.st_size;
+		}
+#endif
+	}
+
+	~MappedFile()
+	{
+#ifdef _WIN32
+		if (data_)
+		{
+			UnmapViewOfFile(data_);
+		}
+		if (mapping_)
+		{
+			CloseHandle(mapping_);
+		}
+		if (file_ != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(file_);
+		}
+#else
+		if (data_)
+		{
+			munmap(const_cast<unsigned char *>(data_), size_);
+		}
+		if (fd_ >= 0)
+		{
+			::close(fd_);
+		}
+#endif
+	}
+
+	const unsigned char *getData() const { return data_; }
+	size_t getSize() const { return size_; }
+
+private:
+#ifdef _WIN32
+	HANDLE file_{INVALID_HANDLE_VALUE};
+	HANDLE mapping_{nullptr};
+#else
+	int fd_{-1};
+#endif
+	const unsigned char *data_{nullptr};
+	size_t size_{0};
+};
+
+bool truncate_file(FILE *file, size_t size)
+{
+	fflush(file);
+#ifdef _WIN32
+	return _chsize_s(_fileno(file), static_cast<long long>(size)) == 0;
+#else
+	return ftruncate(fileno(file), static_cast<off_t>(size)) == 0;
+#endif
+}
+
+void sync_file(FILE *file)
+{
+	fflush(file);
+#ifdef _WIN32
+	_commit(_fileno(file));
+#else
+	fsync(fileno(file));
+#endif
+}
+
+}
+
+void UndoWriter::writeCommand(const UndoCommand *cmd)
+{
+	const uint32_t type = cmd ? cmd->getJournalType() : UndoJournal::TYPE_NONE;
+	write(type);
+
+	const int size_offset = buffer_.size();
+	write(uint32_t(0));
+
+	if (type != UndoJournal::TYPE_NONE)
+	{
+		cmd->write(*this);
+	}
+
+	const uint32_t size = static_cast<uint32_t>(buffer_.size() - size_offset - sizeof(uint32_t));
+	memcpy(buffer_.get() + size_offset, &size, sizeof(size));
+}
+
+UndoJournal::~UndoJournal()
+{
+	close();
+}
+
+int UndoJournal::replay(const char *path, UndoStack &undo_stack, UndoCommandFactory &factory)
+{
+	replayed_path_ = path;
+	replayed_size_ = 0;
+
+	MappedFile file(path);
+	const unsigned char *data = file.getData();
+	if (!data || file.getSize() < HEADER_SIZE || memcmp(data, MAGIC, sizeof(MAGIC)) != 0)
+	{
+		return 0;
+	}
+
+	UndoReader reader(data + HEADER_SIZE, file.getSize() - HEADER_SIZE);
+	uint32_t version = 0;
+	memcpy(&version, data + sizeof(MAGIC), sizeof(version));
+	if (version != VERSION)
+	{
+		return 0;
+	}
+
+	// replayed commands are already in the log
+	UndoJournal *journal = undo_stack.getJournal();
+	undo_stack.setJournal(nullptr);
+
+	int num_records = 0;
+	replayed_size_ = HEADER_SIZE;
+	while (!reader.isEnd())
+	{
+		uint8_t op = 0;
+		reader.read(op);
+
+		if (op == OP_UNDO || op == OP_REDO)
+		{
+			op == OP_UNDO ? undo_stack.undo() : undo_stack.redo();
+		}
+		else if (op == OP_BRANCH)
+		{
+			uint32_t branch = 0;
+			if (reader.read(branch) && static_cast<int>(branch) < undo_stack.getNumBranches())
+			{
+				undo_stack.selectBranch(static_cast<int>(branch));
+			}
+		}
+		else if (op == OP_PUSH || op == OP_MERGE)
+		{
+			UndoCommand *cmd = readCommand(reader, undo_stack, factory);
+			if (!reader.isValid())
+			{
+				delete cmd;
+				break;
+			}
+
+			cmd->redo();
+			if (op == OP_PUSH || !undo_stack.mergeTop(cmd))
+			{
+				undo_stack.append(cmd);
+			}
+			else
+			{
+				delete cmd;
+			}
+		}
+		else
+		{
+			break;
+		}
+
+		if (!reader.isValid())
+		{
+			break;
+		}
+
+		++num_records;
+		replayed_size_ = HEADER_SIZE + reader.getOffset(data + HEADER_SIZE);
+	}
+
+	undo_stack.setJournal(journal);
+	return num_records;
+}
+
+UndoCommand *UndoJournal::readCommand(UndoReader &reader, UndoStack &undo_stack,
+	UndoCommandFactory &factory)
+{
+	uint32_t type = TYPE_NONE;
+	uint32_t size = 0;
+	if (!reader.read(type) || !reader.read(size))
+	{
+		return nullptr;
+	}
+
+	Unigine::Vector<unsigned char> payload;
+	payload.resize(static_cast<int>(size));
+	if (!reader.read(payload.get(), size))
+	{
+		return nullptr;
+	}
+
+	UndoReader payload_reader(payload.get(), size);
+	UndoCommand *cmd = nullptr;
+
+	if (type == TYPE_MACRO)
+	{
+		uint32_t num_commands = 0;
+		payload_reader.read(num_commands);
+
+		auto macro = undo_stack.create<UndoMacro>();
+		for (uint32_t i = 0; i < num_commands && payload_reader.isValid(); ++i)
+		{
+			if (UndoCommand *child = readCommand(payload_reader, undo_stack, factory))
+			{
+				macro->append(child);
+			}
+		}
+		cmd = macro;
+	}
+	else if (type == TYPE_SNAPSHOT)
+	{
+		Unigine::Log::warning(
+			"UndoJournal::replay(): a snapshot isn't journaled, its history entry does nothing\n");
+	}
+	else if (type != TYPE_NONE)
+	{
+		cmd = factory.read(type, payload_reader);
+	}
+
+	return cmd ? cmd : undo_stack.create<UndoPlaceholder>();
+}
+
+bool UndoJournal::open(const char *path)
+{
+	close();
+
+	const bool keep_replayed = replayed_size_ > 0 && replayed_path_ == path;
+
+	file_ = fopen(path, keep_replayed ? "r+b" : "w+b");
+	if (!file_)
+	{
+		Unigine::Log::error("UndoJournal::open(): can't open \"%s\"\n", path);
+		return false;
+	}
+
+	path_ = path;
+
+	if (keep_replayed)
+	{
+		truncate_file(file_, replayed_size_);
+		fseek(file_, 0, SEEK_END);
+	}
+	else
+	{
+		fwrite(MAGIC, sizeof(MAGIC), 1, file_);
+		fwrite(&VERSION, sizeof(VERSION), 1, file_);
+		sync_file(file_);
+	}
+
+	last_sync_time_ = std::chrono::steady_clock::now();
+	return true;
+}
+
+void UndoJournal::close()
+{
+	if (!file_)
+	{
+		return;
+	}
+
+	sync();
+	fclose(file_);
+	file_ = nullptr;
+}
+
+void UndoJournal::discard()
+{
+	if (!file_)
+	{
+		return;
+	}
+
+	buffer_.clear();
+	fclose(file_);
+	file_ = nullptr;
+	remove(path_.get());
+}
+
+void UndoJournal::record(Op op, const UndoCommand *cmd)
+{
+	if (!file_)
+	{
+		return;
+	}
+
+	UndoWriter writer(buffer_);
+	writer.write(static_cast<uint8_t>(op));
+	if (op == OP_PUSH || op == OP_MERGE)
+	{
+		writer.writeCommand(cmd);
+	}
+
+	if (buffer_.size() > MAX_BUFFER_SIZE)
+	{
+		sync();
+	}
+}
+
+void UndoJournal::recordBranch(int branch)
+{
+	if (!file_)
+	{
+		return;
+	}
+
+	UndoWriter writer(buffer_);
+	writer.write(static_cast<uint8_t>(OP_BRANCH));
+	writer.write(static_cast<uint32_t>(branch));
+
+	if (buffer_.size() > MAX_BUFFER_SIZE)
+	{
+		sync();
+	}
+}
+
+void UndoJournal::update()
+{
+	if (buffer_.empty())
+	{
+		return;
+	}
+
+	if (std::chrono::steady_clock::now() - last_sync_time_ >= sync_interval_)
+	{
+		sync();
+	}
+}
+
+void UndoJournal::sync()
+{
+	if (!file_ || buffer_.empty())
+	{
+		return;
+	}
+
+	if (fwrite(buffer_.get(), buffer_.size(), 1, file_) != 1)
+	{
+		Unigine::Log::error("UndoJournal::sync(): can't write \"%s\"\n", path_.get());
+	}
+	sync_file(file_);
+
+	buffer_.clear();
+	last_sync_time_ = std::chrono::steady_clock::now();
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <UnigineString.h>
+#include <UnigineVector.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+class UndoCommand;
+class UndoStack;
+
+class UndoWriter final
+{
+public:
+	explicit UndoWriter(Unigine::Vector<unsigned char> &buffer)
+		: buffer_(buffer)
+	{}
+
+	void write(const void *data, size_t size)
+	{
+		const int offset = buffer_.size();
+		buffer_.resize(offset + static_cast<int>(size));
+		memcpy(buffer_.get() + offset, data, size);
+	}
+
+	template<typename T>
+	void write(const T &value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "journal values must be trivially copyable");
+		write(&value, sizeof(T));
+	}
+
+	// Writes a command as (type, size, payload), commands without a journal type are written empty.
+	void writeCommand(const UndoCommand *cmd);
+
+private:
+	Unigine::Vector<unsigned char> &buffer_;
+};
+
+class UndoReader final
+{
+public:
+	UndoReader(const unsigned char *data, size_t size)
+		: cur_(data)
+		, end_(data + size)
+	{}
+
+	bool read(void *data, size_t size)
+	{
+		// an empty payload may have no buffer to copy to
+		if (size == 0)
+		{
+			return true;
+		}
+
+		if (static_cast<size_t>(end_ - cur_) < size)
+		{
+			cur_ = end_;
+			valid_ = false;
+			return false;
+		}
+
+		memcpy(data, cur_, size);
+		cur_ += size;
+		return true;
+	}
+
+	template<typename T>
+	bool read(T &value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "journal values must be trivially copyable");
+		return read(&value, sizeof(T));
+	}
+
+	bool isValid() const { return valid_; }
+	bool isEnd() const { return cur_ == end_; }
+	size_t getOffset(const unsigned char *begin) const { return cur_ - begin; }
+
+private:
+	const unsigned char *cur_{};
+	const unsigned char *end_{};
+	bool valid_{true};
+};
+
+// Rebuilds journaled commands on replay, returns nullptr for unknown or stale ones.
+class UndoCommandFactory
+{
+public:
+	virtual ~UndoCommandFactory() = default;
+	virtual UndoCommand *read(uint32_t type, UndoReader &reader) = 0;
+};
+
+// Append-only log of pushed, undone and redone commands and of selected branches,
+// for crash recovery.
+// Records are buffered and written with one fsync per sync interval.
+class UndoJournal final
+{
+public:
+	enum : uint32_t
+	{
+		TYPE_NONE = 0,
+		TYPE_MACRO = 1,
+		// written without a payload and replayed as a placeholder, see SnapshotCommand
+		TYPE_SNAPSHOT = 2,
+	};
+
+	enum Op : uint8_t
+	{
+		OP_PUSH = 1,
+		OP_MERGE = 2,
+		OP_UNDO = 3,
+		OP_REDO = 4,
+		// followed by the branch selected for the next redo
+		OP_BRANCH = 5,
+	};
+
+	UndoJournal() = default;
+	~UndoJournal();
+
+	UndoJournal(const UndoJournal &) = delete;
+	UndoJournal &operator=(const UndoJournal &) = delete;
+
+	// Replays the log at path into the stack, returns the number of replayed records.
+	// Call it before open() on the same path, a broken tail is dropped by open().
+	int replay(const char *path, UndoStack &undo_stack, UndoCommandFactory &factory);
+
+	bool open(const char *path);
+	void close();
+	// closes and removes the log, e.g. on clean shutdown
+	void discard();
+	bool isOpen() const { return file_ != nullptr; }
+
+	void record(Op op, const UndoCommand *cmd = nullptr);
+	void recordBranch(int branch);
+
+	// Writes pending records if the sync interval has passed, call it once per frame.
+	void update();
+	void sync();
+
+	void setSyncInterval(int milliseconds) { sync_interval_ = std::chrono::milliseconds(milliseconds); }
+	int getSyncInterval() const { return static_cast<int>(sync_interval_.count()); }
+
+private:
+	UndoCommand *readCommand(UndoReader &reader, UndoStack &undo_stack,
+		UndoCommandFactory &factory);
+
+	FILE *file_{nullptr};
+	Unigine::String path_;
+	Unigine::String replayed_path_;
+	size_t replayed_size_{0};
+
+	Unigine::Vector<unsigned char> buffer_;
+	std::chrono::milliseconds sync_interval_{250};
+	std::chrono::steady_clock::time_point last_sync_time_;
+};
@@ -1,41 +1,667 @@
 #include "UndoStack.h"
+#include "Trace.h"
+#include "UndoJournal.h"
 
+#include <algorithm>
+#include <new>
+
+namespace
+{
+
+// precedes every command, tells delete where the block came from
+struct alignas(16) BlockHeader
+{
+	UndoPool *pool;
+	size_t size;
+};
+
+constexpr size_t align_size(size_t size, size_t alignment)
+{
+	return (size + alignment - 1) & ~(alignment - 1);
+}
+
+}
+
+UndoPool::~UndoPool()
+{
+	for (const auto &chunk : chunks_)
+	{
+		::operator delete(chunk);
+	}
+}
+
+void *UndoPool::allocate(size_t size)
+{
+	size = align_size(size, GRANULARITY);
+	++num_alive_;
+
+	if (size > MAX_BLOCK_SIZE)
+	{
+		return ::operator new(size);
+	}
+
+	FreeBlock *&free_list = free_lists_[size / GRANULARITY - 1];
+	if (free_list)
+	{
+		FreeBlock *block = free_list;
+		free_list = block->next;
+		return block;
+	}
+
+	if (chunk_offset_ + size > CHUNK_SIZE)
+	{
+		if (++chunk_index_ == chunks_.size())
+		{
+			chunks_.append(static_cast<char *>(::operator new(CHUNK_SIZE)));
+		}
+		chunk_offset_ = 0;
+	}
+
+	void *ptr = chunks_[chunk_index_] + chunk_offset_;
+	chunk_offset_ += size;
+	return ptr;
+}
+
+void UndoPool::release(void *ptr, size_t size)
+{
+	size = align_size(size, GRANULARITY);
+
+	if (size > MAX_BLOCK_SIZE)
+	{
+		::operator delete(ptr);
+	}
+	else
+	{
+		auto block = static_cast<FreeBlock *>(ptr);
+		FreeBlock *&free_list = free_lists_[size / GRANULARITY - 1];
+		block->next = free_list;
+		free_list = block;
+	}
+
+	if (--num_alive_ == 0)
+	{
+		rewind();
+	}
+}
+
+void UndoPool::rewind()
+{
+	for (auto &free_list : free_lists_)
+	{
+		free_list = nullptr;
+	}
+	chunk_index_ = chunks_.empty() ? -1 : 0;
+	chunk_offset_ = chunks_.empty() ? CHUNK_SIZE : 0;
+}
+
+void *UndoCommand::operator new(size_t size)
+{
+	auto header = static_cast<BlockHeader *>(::operator new(sizeof(BlockHeader) + size));
+	header->pool = nullptr;
+	header->size = sizeof(BlockHeader) + size;
+	return header + 1;
+}
+
+void *UndoCommand::operator new(size_t size, UndoPool &pool)
+{
+	auto header = static_cast<BlockHeader *>(pool.allocate(sizeof(BlockHeader) + size));
+	header->pool = &pool;
+	header->size = sizeof(BlockHeader) + size;
+	return header + 1;
+}
+
+void UndoCommand::operator delete(void *ptr)
+{
+	if (!ptr)
+	{
+		return;
+	}
+
+	BlockHeader *header = static_cast<BlockHeader *>(ptr) - 1;
+	if (header->pool)
+	{
+		header->pool->release(header, header->size);
+	}
+	else
+	{
+		::operator delete(header);
+	}
+}
+
+void UndoCommand::operator delete(void *ptr, UndoPool &pool)
+{
+	BlockHeader *header = static_cast<BlockHeader *>(ptr) - 1;
+	pool.release(header, header->size);
+}
+
+int UndoCommand::allocateId()
+{
+	static int next_id = 0;
+	return next_id++;
+}
+
+UndoMacro::~UndoMacro()
+{
+	commands_.destroy();
+}
+
+void UndoMacro::undo()
+{
+	for (int i = commands_.size() - 1; i >= 0; --i)
+	{
+		commands_[i]->undo();
+	}
+}
+
+void UndoMacro::redo()
+{
+	for (const auto &cmd : commands_)
+	{
+		cmd->redo();
+	}
+}
+
+size_t UndoMacro::getMemoryUsage() const
+{
+	size_t usage = sizeof(UndoMacro) + commands_.size() * sizeof(UndoCommand *);
+	for (const auto &cmd : commands_)
+	{
+		usage += cmd->getMemoryUsage();
+	}
+	return usage;
+}
+
+uint32_t UndoMacro::getJournalType() const
+{
+	return UndoJournal::TYPE_MACRO;
+}
+
+void UndoMacro::write(UndoWriter &writer) const
+{
+	writer.write(static_cast<uint32_t>(commands_.size()));
+	for (const auto &cmd : commands_)
+	{
+		writer.writeCommand(cmd);
+	}
+}
+
+UndoStack::UndoStack()
+{
+	root_ = allocateNode(nullptr, NO_NODE);
+	current_ = root_;
+}
 
 UndoStack::~UndoStack()
 {
-	stack_.destroy();
+	delete macro_;
+	for (const auto &node : nodes_)
+	{
+		delete node.cmd;
+	}
 }
 
 void UndoStack::redo()
 {
-	if (index_ == stack_.size())
+	TRACE_SCOPE("UndoStack::redo");
+
+	assert(!isInMacro());
+
+	const int child = nodes_[current_].redo_child;
+	if (isInMacro() || child == NO_NODE)
 	{
 		return;
 	}
 
-	UndoCommand *cmd = stack_.at(index_++);
-	cmd->redo();
+	current_ = child;
+	nodes_[current_].cmd->redo();
+
+	if (journal_)
+	{
+		journal_->record(UndoJournal::OP_REDO);
+	}
 }
 
 void UndoStack::undo()
 {
-	if (index_ == 0)
+	TRACE_SCOPE("UndoStack::undo");
+
+	assert(!isInMacro());
+
+	if (isInMacro() || current_ == root_)
 	{
 		return;
 	}
 
-	UndoCommand *cmd = stack_.at(--index_);
-	cmd->undo();
+	Node &node = nodes_[current_];
+	node.cmd->undo();
+
+	// redo brings back what was just undone
+	nodes_[node.parent].redo_child = current_;
+	current_ = node.parent;
+
+	if (journal_)
+	{
+		journal_->record(UndoJournal::OP_UNDO);
+	}
 }
 
 void UndoStack::push(UndoCommand *cmd)
 {
-	while (index_ < stack_.size())
+	TRACE_SCOPE("UndoStack::push");
+
+	cmd->redo();
+
+	if (isInMacro())
 	{
-		delete stack_.takeLast();
+		macro_->append(cmd);
+		return;
 	}
 
-	stack_.push_back(cmd);
-	cmd->redo();
-	++index_;
+	const bool merged = merge(cmd);
+	if (journal_)
+	{
+		journal_->record(merged ? UndoJournal::OP_MERGE : UndoJournal::OP_PUSH, cmd);
+	}
+
+	if (merged)
+	{
+		delete cmd;
+		return;
+	}
+
+	append(cmd);
+}
+
+void UndoStack::jumpTo(int node)
+{
+	TRACE_SCOPE("UndoStack::jumpTo");
+
+	assert(!isInMacro());
+	assert(isNode(node));
+
+	if (isInMacro() || !isNode(node))
+	{
+		return;
+	}
+
+	int ancestor = current_;
+	int other = node;
+	while (nodes_[ancestor].depth > nodes_[other].depth)
+	{
+		ancestor = nodes_[ancestor].parent;
+	}
+	while (nodes_[other].depth > nodes_[ancestor].depth)
+	{
+		other = nodes_[other].parent;
+	}
+	while (ancestor != other)
+	{
+		ancestor = nodes_[ancestor].parent;
+		other = nodes_[other].parent;
+	}
+
+	while (current_ != ancestor)
+	{
+		undo();
+	}
+
+	// the way down is collected from the node up
+	Unigine::Vector<int> path;
+	for (int i = node; i != ancestor; i = nodes_[i].parent)
+	{
+		path.append(i);
+	}
+
+	for (int i = path.size() - 1; i >= 0; --i)
+	{
+		if (nodes_[current_].redo_child != path[i])
+		{
+			selectChild(path[i]);
+		}
+		redo();
+	}
+}
+
+void UndoStack::selectBranch(int branch)
+{
+	assert(branch >= 0 && branch < getNumBranches());
+
+	if (branch < 0 || branch >= getNumBranches())
+	{
+		return;
+	}
+
+	selectChild(getChildNode(current_, branch));
+}
+
+int UndoStack::getNumChildNodes(int node) const
+{
+	int count = 0;
+	for (int i = nodes_[node].first_child; i != NO_NODE; i = nodes_[i].next_sibling)
+	{
+		++count;
+	}
+	return count;
+}
+
+int UndoStack::getChildNode(int node, int i) const
+{
+	// the list starts with the newest child
+	int child = nodes_[node].first_child;
+	for (int skip = getNumChildNodes(node) - 1 - i; skip > 0; --skip)
+	{
+		child = nodes_[child].next_sibling;
+	}
+	return child;
+}
+
+void UndoStack::beginMacro()
+{
+	if (macro_depth_++ == 0)
+	{
+		macro_ = create<UndoMacro>();
+	}
+}
+
+void UndoStack::endMacro()
+{
+	assert(isInMacro());
+
+	if (--macro_depth_ > 0)
+	{
+		return;
+	}
+
+	UndoMacro *macro = macro_;
+	macro_ = nullptr;
+
+	if (macro->isEmpty())
+	{
+		delete macro;
+		return;
+	}
+
+	if (journal_)
+	{
+		journal_->record(UndoJournal::OP_PUSH, macro);
+	}
+
+	append(macro);
+}
+
+void UndoStack::setCountLimit(int count)
+{
+	count_limit_ = count;
+	evict();
+}
+
+void UndoStack::setMemoryLimit(size_t bytes)
+{
+	memory_limit_ = bytes;
+	evict();
+}
+
+size_t UndoStack::getMemoryUsage() const
+{
+	return memory_usage_;
+}
+
+int UndoStack::size() const
+{
+	return nodes_[getLineEnd()].depth - nodes_[root_].depth;
+}
+
+bool UndoStack::merge(UndoCommand *cmd)
+{
+	const auto now = std::chrono::steady_clock::now();
+	const bool in_window = now - last_push_time_ <= merge_window_;
+	last_push_time_ = now;
+
+	return in_window && mergeTop(cmd);
+}
+
+bool UndoStack::mergeTop(UndoCommand *cmd)
+{
+	Node &top = nodes_[current_];
+
+	// the branches of a node were made on top of its command, it stays as is
+	if (current_ == root_ || top.first_child != NO_NODE || cmd->id() < 0)
+	{
+		return false;
+	}
+
+	if (top.cmd->id() != cmd->id() || !top.cmd->mergeWith(cmd))
+	{
+		return false;
+	}
+
+	memory_usage_ -= top.memory_usage;
+	top.memory_usage = sizeof(Node) + top.cmd->getMemoryUsage();
+	memory_usage_ += top.memory_usage;
+
+	evict();
+	return true;
+}
+
+void UndoStack::append(UndoCommand *cmd)
+{
+	current_ = allocateNode(cmd, current_);
+	++num_commands_;
+
+	evict();
+}
+
+void UndoStack::selectChild(int child)
+{
+	nodes_[current_].redo_child = child;
+
+	if (journal_)
+	{
+		journal_->recordBranch(getBranch(child));
+	}
+}
+
+int UndoStack::getBranch(int child) const
+{
+	// older siblings follow in the list
+	int branch = 0;
+	for (int i = nodes_[child].next_sibling; i != NO_NODE; i = nodes_[i].next_sibling)
+	{
+		++branch;
+	}
+	return branch;
+}
+
+int UndoStack::getLineEnd() const
+{
+	int node = current_;
+	while (nodes_[node].redo_child != NO_NODE)
+	{
+		node = nodes_[node].redo_child;
+	}
+	return node;
+}
+
+int UndoStack::allocateNode(UndoCommand *cmd, int parent)
+{
+	int index = free_node_;
+	if (index != NO_NODE)
+	{
+		free_node_ = nodes_[index].next_sibling;
+	}
+	else
+	{
+		index = nodes_.size();
+		nodes_.append(Node());
+	}
+
+	Node &node = nodes_[index];
+	node.cmd = cmd;
+	node.memory_usage = cmd ? sizeof(Node) + cmd->getMemoryUsage() : 0;
+	node.parent = parent;
+	node.first_child = NO_NODE;
+	node.next_sibling = NO_NODE;
+	node.redo_child = NO_NODE;
+	node.depth = 0;
+	node.serial = next_serial_++;
+	memory_usage_ += node.memory_usage;
+
+	if (parent != NO_NODE)
+	{
+		Node &parent_node = nodes_[parent];
+		node.depth = parent_node.depth + 1;
+		node.next_sibling = parent_node.first_child;
+		parent_node.first_child = index;
+		parent_node.redo_child = index;
+	}
+
+	pushLeaf(index);
+	return index;
+}
+
+void UndoStack::releaseNode(int index)
+{
+	Node &node = nodes_[index];
+	memory_usage_ -= node.memory_usage;
+	delete node.cmd;
+
+	node.cmd = nullptr;
+	node.memory_usage = 0;
+	node.parent = FREE_NODE;
+	node.next_sibling = free_node_;
+	free_node_ = index;
+}
+
+void UndoStack::removeLeaf(int index)
+{
+	Node &parent = nodes_[nodes_[index].parent];
+
+	int *link = &parent.first_child;
+	while (*link != index)
+	{
+		link = &nodes_[*link].next_sibling;
+	}
+	*link = nodes_[index].next_sibling;
+
+	if (parent.redo_child == index)
+	{
+		parent.redo_child = parent.first_child;
+	}
+
+	const int parent_index = nodes_[index].parent;
+	releaseNode(index);
+	--num_commands_;
+
+	if (nodes_[parent_index].first_child == NO_NODE)
+	{
+		pushLeaf(parent_index);
+	}
+}
+
+bool UndoStack::isLeaf(const Leaf &leaf) const
+{
+	// a released node may be reused by a newer one
+	const Node &node = nodes_[leaf.node];
+	return node.parent != FREE_NODE && node.serial == leaf.serial && node.first_child == NO_NODE;
+}
+
+void UndoStack::pushLeaf(int node)
+{
+	// drops the stale entries once they outnumber the nodes, a linear history
+	// evicts through the root and never pops them
+	if (leaves_.size() > 2 * nodes_.size())
+	{
+		int size = 0;
+		for (int i = 0; i < leaves_.size(); ++i)
+		{
+			if (isLeaf(leaves_[i]))
+			{
+				leaves_[size++] = leaves_[i];
+			}
+		}
+		leaves_.resize(size);
+		std::make_heap(leaves_.get(), leaves_.get() + size);
+	}
+
+	leaves_.append(Leaf{nodes_[node].serial, node});
+	std::push_heap(leaves_.get(), leaves_.get() + leaves_.size());
+}
+
+int UndoStack::popOldestLeaf(int line_end)
+{
+	// the end of the line and the root are kept, so are their entries
+	Leaf kept[2];
+	int num_kept = 0;
+	int oldest = NO_NODE;
+	while (oldest == NO_NODE && !leaves_.empty())
+	{
+		std::pop_heap(leaves_.get(), leaves_.get() + leaves_.size());
+		const Leaf leaf = leaves_.last();
+		leaves_.removeAt(leaves_.size() - 1);
+
+		if (!isLeaf(leaf))
+		{
+			continue;
+		}
+
+		if (leaf.node == line_end || leaf.node == root_)
+		{
+			kept[num_kept++] = leaf;
+		}
+		else
+		{
+			oldest = leaf.node;
+		}
+	}
+
+	for (int i = 0; i < num_kept; ++i)
+	{
+		leaves_.append(kept[i]);
+		std::push_heap(leaves_.get(), leaves_.get() + leaves_.size());
+	}
+	return oldest;
+}
+
+void UndoStack::evictRoot()
+{
+	// branches are pruned first, the root has a single child
+	const int first = nodes_[root_].first_child;
+	assert(nodes_[first].next_sibling == NO_NODE);
+
+	// the oldest command is applied, the state after it is where history starts now
+	Node &node = nodes_[first];
+	memory_usage_ -= node.memory_usage;
+	delete node.cmd;
+	node.cmd = nullptr;
+	node.memory_usage = 0;
+	node.parent = NO_NODE;
+
+	releaseNode(root_);
+	root_ = first;
+	--num_commands_;
+}
+
+void UndoStack::evict()
+{
+	// the latest entry is kept even if it doesn't fit the budget alone
+	while (num_commands_ > 1
+		&& ((count_limit_ > 0 && num_commands_ > count_limit_)
+			|| (memory_limit_ > 0 && memory_usage_ > memory_limit_)))
+	{
+		// every node of the line has children but its end, other leaves are off the line
+		const int line_end = getLineEnd();
+		if (nodes_[line_end].depth - nodes_[root_].depth < num_commands_)
+		{
+			removeLeaf(popOldestLeaf(line_end));
+		}
+		else if (current_ != root_)
+		{
+			evictRoot();
+		}
+		else
+		{
+			// nothing is applied, drop the newest redo entry instead
+			removeLeaf(line_end);
+		}
+	}
 }
@@ -2,24 +2,278 @@
 
 #include <UnigineVector.h>
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+class UndoJournal;
+class UndoWriter;
+
+// Size-class pool for undo commands. Blocks are carved from large chunks and
+// recycled through per-size free lists; once no block is alive the chunks are
+// rewound at once, so clearing and pruning history free memory in bulk.
+class UndoPool final
+{
+public:
+	UndoPool() = default;
+	~UndoPool();
+
+	UndoPool(const UndoPool &) = delete;
+	UndoPool &operator=(const UndoPool &) = delete;
+
+	void *allocate(size_t size);
+	void release(void *ptr, size_t size);
+
+	int getNumAlive() const { return num_alive_; }
+	size_t getReservedMemory() const { return chunks_.size() * CHUNK_SIZE; }
+
+private:
+	static constexpr size_t GRANULARITY = 16;
+	static constexpr size_t MAX_BLOCK_SIZE = 512;
+	static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+	struct FreeBlock
+	{
+		FreeBlock *next;
+	};
+
+	void rewind();
+
+	FreeBlock *free_lists_[MAX_BLOCK_SIZE / GRANULARITY]{};
+	Unigine::Vector<char *> chunks_;
+	int chunk_index_{-1};
+	size_t chunk_offset_{CHUNK_SIZE};
+	int num_alive_{0};
+};
+
 class UndoCommand
 {
 public:
+	// Commands may live in an UndoPool, a plain delete returns them where they came from.
+	static void *operator new(size_t size);
+	static void *operator new(size_t size, UndoPool &pool);
+	static void operator delete(void *ptr);
+	static void operator delete(void *ptr, UndoPool &pool);
+
 	virtual ~UndoCommand() = default;
 	virtual void undo() = 0;
 	virtual void redo() = 0;
+
+	// Consecutive commands with the same non-negative id are offered to mergeWith(),
+	// the latest command absorbs the pushed one when it returns true.
+	virtual int id() const { return -1; }
+	virtual bool mergeWith(const UndoCommand *other) { return false; }
+
+	// Approximate heap footprint in bytes, used for the history budget.
+	virtual size_t getMemoryUsage() const { return sizeof(UndoCommand); }
+
+	// Journal support. Commands with a non-zero type write their payload and are
+	// rebuilt on replay by an UndoCommandFactory, see UndoJournal.
+	virtual uint32_t getJournalType() const { return 0; }
+	virtual void write(UndoWriter &writer) const {}
+
+protected:
+	// unique id per command class
+	template<typename CommandT>
+	static int typeId()
+	{
+		static const int id = allocateId();
+		return id;
+	}
+
+private:
+	static int allocateId();
+};
+
+// Compound command, undone and redone as a single step.
+class UndoMacro final : public UndoCommand
+{
+public:
+	~UndoMacro() override;
+
+	void append(UndoCommand *cmd) { commands_.append(cmd); }
+	bool isEmpty() const { return commands_.empty(); }
+	int size() const { return commands_.size(); }
+	const UndoCommand *at(int i) const { return commands_[i]; }
+
+	void undo() override;
+	void redo() override;
+
+	size_t getMemoryUsage() const override;
+
+	uint32_t getJournalType() const override;
+	void write(UndoWriter &writer) const override;
+
+private:
+	Unigine::Vector<UndoCommand *> commands_;
 };
 
+// History is a tree: a push after undo starts a new branch next to the undone commands
+// instead of dropping them. redo() follows the branch last pushed or undone, or the one
+// chosen with selectBranch(); jumpTo() moves to any node through the common ancestor.
 class UndoStack final
 {
 public:
+	static constexpr int NO_NODE = -1;
+
+	UndoStack();
 	~UndoStack();
 
+	UndoStack(const UndoStack &) = delete;
+	UndoStack &operator=(const UndoStack &) = delete;
+
+	// Allocates a command from the stack's pool, it is still released with delete
+	// but must not outlive the stack.
+	template<typename CommandT, typename... Args>
+	CommandT *create(Args &&...args)
+	{
+		return new (pool_) CommandT(std::forward<Args>(args)...);
+	}
+
+	const UndoPool &getPool() const { return pool_; }
+
 	void redo();
 	void undo();
 	void push(UndoCommand *cmd);
 
+	// Undoes up to the common ancestor of the current node and the node, then redoes
+	// down to the node.
+	void jumpTo(int node);
+
+	// Chooses the branch redo() follows from the current node, 0 is the oldest one.
+	void selectBranch(int branch);
+	int getNumBranches() const { return getNumChildNodes(current_); }
+
+	// Nodes of the tree, the root stands for the state before the oldest command.
+	// Ids of pruned nodes are reused.
+	int getRootNode() const { return root_; }
+	int getCurrentNode() const { return current_; }
+	bool isNode(int node) const { return node >= 0 && node < nodes_.size() && nodes_[node].parent != FREE_NODE; }
+	int getParentNode(int node) const { return nodes_[node].parent; }
+	int getNumChildNodes(int node) const;
+	// children in push order, 0 is the oldest one
+	int getChildNode(int node, int i) const;
+	const UndoCommand *getCommand(int node) const { return nodes_[node].cmd; }
+
+	// Commands pushed between beginMacro() and endMacro() are applied right away
+	// and recorded as one history entry. Nested macros are flattened into the outermost one.
+	void beginMacro();
+	void endMacro();
+	bool isInMacro() const { return macro_depth_ > 0; }
+
+	// Pushes within the window after the previous push may be merged, 0 disables merging.
+	void setMergeWindow(int milliseconds) { merge_window_ = std::chrono::milliseconds(milliseconds); }
+	int getMergeWindow() const { return static_cast<int>(merge_window_.count()); }
+
+	// History limits, counted over all branches. Branches off the current line are
+	// pruned first, the oldest one first, then the oldest entries of the line.
+	// 0 means unlimited.
+	void setCountLimit(int count);
+	int getCountLimit() const { return count_limit_; }
+	void setMemoryLimit(size_t bytes);
+	size_t getMemoryLimit() const { return memory_limit_; }
+
+	// bytes held by the commands and their nodes, the amount the memory limit bounds
+	size_t getMemoryUsage() const;
+	int getNumCommands() const { return num_commands_; }
+	// entries of the current line, from the root to the end of the redo branch
+	int size() const;
+	int getIndex() const { return nodes_[current_].depth - nodes_[root_].depth; }
+
+	// Streams pushed, undone and redone commands to the journal, nullptr disables it.
+	void setJournal(UndoJournal *journal) { journal_ = journal; }
+	UndoJournal *getJournal() const { return journal_; }
+
+private:
+	friend class UndoJournal;
+
+	static constexpr int FREE_NODE = -2;
+
+	// Nodes are linked by index, a free node is linked through next_sibling.
+	struct Node
+	{
+		UndoCommand *cmd;
+		// of the command and the node
+		size_t memory_usage;
+		int parent;
+		// children are linked from the newest one to the oldest one
+		int first_child;
+		int next_sibling;
+		// followed by redo, set whenever the node has children
+		int redo_child;
+		// from the first root, kept when older nodes are evicted
+		int depth;
+		// push order, the oldest branches are pruned first
+		uint32_t serial;
+	};
+
+	// heap entry, the oldest leaf is on top
+	struct Leaf
+	{
+		uint32_t serial;
+		int node;
+
+		bool operator<(const Leaf &other) const { return serial > other.serial; }
+	};
+
+	bool merge(UndoCommand *cmd);
+	bool mergeTop(UndoCommand *cmd);
+
+	void append(UndoCommand *cmd);
+	void selectChild(int child);
+	int getBranch(int child) const;
+	int getLineEnd() const;
+
+	int allocateNode(UndoCommand *cmd, int parent);
+	void releaseNode(int node);
+	void removeLeaf(int node);
+	bool isLeaf(const Leaf &leaf) const;
+	void pushLeaf(int node);
+	int popOldestLeaf(int line_end);
+	void evictRoot();
+	void evict();
+
+	// declared first, commands are released into it
+	UndoPool pool_;
+
+	Unigine::Vector<Node> nodes_;
+	int free_node_{NO_NODE};
+	int root_{NO_NODE};
+	int current_{NO_NODE};
+	int num_commands_{0};
+	uint32_t next_serial_{0};
+	// Leaves by serial for eviction. Entries of nodes that got a child or were
+	// released stay until they reach the top or the heap is rebuilt.
+	Unigine::Vector<Leaf> leaves_;
+
+	int count_limit_{0};
+	size_t memory_limit_{0};
+	size_t memory_usage_{0};
+
+	int macro_depth_{0};
+	UndoMacro *macro_{nullptr};
+
+	std::chrono::milliseconds merge_window_{500};
+	std::chrono::steady_clock::time_point last_push_time_;
+
+	UndoJournal *journal_{nullptr};
+};
+
+class UndoMacroScope final
+{
+public:
+	explicit UndoMacroScope(UndoStack &undo_stack)
+		: undo_stack_(undo_stack)
+	{
+		undo_stack_.beginMacro();
+	}
+
+	~UndoMacroScope() { undo_stack_.endMacro(); }
+
+	UndoMacroScope(const UndoMacroScope &) = delete;
+	UndoMacroScope &operator=(const UndoMacroScope &) = delete;
+
 private:
-	int index_{0};
-	Unigine::Vector<UndoCommand *> stack_;
+	UndoStack &undo_stack_;
 };
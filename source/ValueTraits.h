@@ -0,0 +1,69 @@
+#pragma once
+
+#include <UnigineMathLib.h>
+
+#include <type_traits>
+
+namespace binds
+{
+
+// Describes bound value types component-wise, scalars have a single component.
+template<typename T>
+struct ValueTraits
+{
+	using Component = T;
+	static constexpr int size = 1;
+
+	static Component get(const T &value, int) { return value; }
+	static void set(T &value, int, Component component) { value = component; }
+};
+
+template<typename VecT, typename ComponentT, int Size>
+struct VectorTraits
+{
+	using Component = ComponentT;
+	static constexpr int size = Size;
+
+	static Component get(const VecT &value, int i) { return value[i]; }
+	static void set(VecT &value, int i, Component component) { value[i] = component; }
+};
+
+template<>
+struct ValueTraits<Unigine::Math::vec2> : VectorTraits<Unigine::Math::vec2, float, 2>
+{};
+template<>
+struct ValueTraits<Unigine::Math::vec3> : VectorTraits<Unigine::Math::vec3, float, 3>
+{};
+template<>
+struct ValueTraits<Unigine::Math::vec4> : VectorTraits<Unigine::Math::vec4, float, 4>
+{};
+template<>
+struct ValueTraits<Unigine::Math::dvec2> : VectorTraits<Unigine::Math::dvec2, double, 2>
+{};
+template<>
+struct ValueTraits<Unigine::Math::dvec3> : VectorTraits<Unigine::Math::dvec3, double, 3>
+{};
+template<>
+struct ValueTraits<Unigine::Math::dvec4> : VectorTraits<Unigine::Math::dvec4, double, 4>
+{};
+template<>
+struct ValueTraits<Unigine::Math::ivec2> : VectorTraits<Unigine::Math::ivec2, int, 2>
+{};
+template<>
+struct ValueTraits<Unigine::Math::ivec3> : VectorTraits<Unigine::Math::ivec3, int, 3>
+{};
+template<>
+struct ValueTraits<Unigine::Math::ivec4> : VectorTraits<Unigine::Math::ivec4, int, 4>
+{};
+
+template<typename T>
+constexpr bool is_vector_value_v = ValueTraits<T>::size > 1;
+
+template<typename T>
+constexpr bool is_number_value_v = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+// values that can be offset by a delta, see ApplyMode::Relative
+template<typename T>
+constexpr bool is_relative_value_v = is_number_value_v<T> || is_vector_value_v<T>;
+
+}
@@ -0,0 +1,354 @@
+// Headless micro-benchmarks of the bindings library and the undo stack.
+// Prints ns/op and heap allocations/op, run a Release build for meaningful numbers.
+
+#include "Bindings.h"
+#include "Snapshot.h"
+#include "TableView.h"
+#include "UndoStack.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+std::atomic<uint64_t> num_allocations{0};
+
+// Bound instance, stands in for an engine node.
+class Panel
+{
+public:
+	float getWidth() const { return width_; }
+	void setWidth(float width) { width_ = width; }
+	bool isEnabled() const { return enabled_; }
+	void setEnabled(bool enabled) { enabled_ = enabled; }
+
+private:
+	float width_{1.0f};
+	bool enabled_{true};
+};
+
+using PanelPtr = Unigine::Ptr<Panel>;
+
+PanelPtr create_panel()
+{
+	return PanelPtr(std::make_shared<Panel>());
+}
+
+// A row of a property table for snapshots, see PropertySheet.h.
+struct WidthProperty
+{
+	using Accessor = binds::MemberAccessor<&Panel::getWidth, &Panel::setWidth>;
+	using Value = float;
+
+	const char *path;
+};
+
+// Sets an int, the cheapest possible command.
+class SetIntCommand final : public UndoCommand
+{
+public:
+	SetIntCommand(int *target, int value)
+		: target_(target)
+		, old_value_(*target)
+		, new_value_(value)
+	{}
+
+	void redo() override { *target_ = new_value_; }
+	void undo() override { *target_ = old_value_; }
+
+private:
+	int *target_{};
+	int old_value_{0};
+	int new_value_{0};
+};
+
+constexpr int SIZES[] = {10, 100, 1000, 10000, 100000};
+constexpr double MIN_TIME_NS = 50e6;
+constexpr int HISTORY_LIMIT = 1024;
+
+// Calls the function until the minimum time is spent, each call performs num_ops operations.
+template<typename Func>
+void run(const char *name, int num_bindings, int num_ops, Func &&func)
+{
+	using namespace std::chrono;
+
+	func(); // warm up caches and lazily grown buffers
+
+	int num_calls = 0;
+	const uint64_t allocations = num_allocations.load(std::memory_order_relaxed);
+	const auto start = steady_clock::now();
+	double elapsed = 0.0;
+	do
+	{
+		func();
+		++num_calls;
+		elapsed = static_cast<double>(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+	} while (elapsed < MIN_TIME_NS);
+
+	const double ops = static_cast<double>(num_calls) * num_ops;
+	const double allocs = static_cast<double>(num_allocations.load(std::memory_order_relaxed)
+		- allocations);
+	printf("%-32s %8d %12.1f %12.2f\n", name, num_bindings, elapsed / ops, allocs / ops);
+}
+
+// One widget per binding, every binding is polled, the views are refreshed only
+// when the value changed. Measures one refreshed binding per op.
+template<typename Source>
+void bench_update(const char *variant, const Source &source,
+	const Unigine::Vector<PanelPtr> &panels, int num_bindings)
+{
+	UndoStack undo_stack;
+	binds::Binder<Panel, Source> binder(undo_stack, source);
+
+	std::vector<Unigine::WidgetEditLinePtr> widgets;
+	widgets.reserve(num_bindings);
+	for (int i = 0; i < num_bindings; ++i)
+	{
+		auto binding = binder.template create<&Panel::getWidth, &Panel::setWidth>();
+		widgets.push_back(Unigine::WidgetEditLine::create());
+		binding->attach(widgets.back());
+		binding->setPolling(true);
+	}
+	binder.update();
+
+	std::string name = std::string("update.unchanged/") + variant;
+	run(name.c_str(), num_bindings, num_bindings, [&] { binder.update(); });
+
+	float width = 1.0f;
+	name = std::string("update.changed/") + variant;
+	run(name.c_str(), num_bindings, num_bindings, [&] {
+		width += 1.0f;
+		for (const auto &panel : panels)
+		{
+			panel->setWidth(width);
+		}
+		binder.update();
+	});
+}
+
+// Undoable writes through a binding, each one is pushed as a history entry.
+template<typename Source>
+void bench_set(const char *variant, const Source &source, int num_bindings)
+{
+	UndoStack undo_stack;
+	undo_stack.setMergeWindow(0);
+	undo_stack.setCountLimit(HISTORY_LIMIT);
+	binds::Binder<Panel, Source> binder(undo_stack, source);
+
+	using BindingT = std::remove_pointer_t<decltype(binder.template create<&Panel::getWidth,
+		&Panel::setWidth>())>;
+	std::vector<BindingT *> bindings;
+	for (int i = 0; i < num_bindings; ++i)
+	{
+		bindings.push_back(binder.template create<&Panel::getWidth, &Panel::setWidth>());
+	}
+
+	float width = 1.0f;
+	std::string name = std::string("binding.set/") + variant;
+	run(name.c_str(), num_bindings, num_bindings, [&] {
+		for (const auto &binding : bindings)
+		{
+			width += 1.0f;
+			binding->set(width);
+		}
+	});
+}
+
+void bench_find(int num_bindings)
+{
+	PanelPtr panel = create_panel();
+	UndoStack undo_stack;
+	binds::Binder<Panel> binder(undo_stack, panel);
+
+	std::vector<std::string> paths;
+	for (int i = 0; i < num_bindings; ++i)
+	{
+		paths.push_back("panel." + std::to_string(i) + ".width");
+		binder.create<&Panel::getWidth, &Panel::setWidth>(paths.back().c_str());
+	}
+
+	std::vector<binds::BindingPath> keys;
+	for (const auto &path : paths)
+	{
+		keys.emplace_back(path.c_str());
+	}
+	run("binder.find", num_bindings, num_bindings, [&] {
+		for (const auto &key : keys)
+		{
+			if (!binder.find(key))
+			{
+				abort();
+			}
+		}
+	});
+}
+
+void bench_undo_stack(int size)
+{
+	UndoStack undo_stack;
+	undo_stack.setMergeWindow(0);
+	undo_stack.setCountLimit(size);
+
+	int value = 0;
+	run("undostack.push", size, size, [&] {
+		for (int i = 0; i < size; ++i)
+		{
+			undo_stack.push(undo_stack.create<SetIntCommand>(&value, i));
+		}
+	});
+
+	run("undostack.undo+redo", size, size, [&] {
+		for (int i = 0; i < size; ++i)
+		{
+			undo_stack.undo();
+		}
+		for (int i = 0; i < size; ++i)
+		{
+			undo_stack.redo();
+		}
+	});
+}
+
+// A bulk edit of every panel recorded as one snapshot, measures one instance per op.
+void bench_snapshot(int size)
+{
+	Unigine::Vector<PanelPtr> panels;
+	for (int i = 0; i < size; ++i)
+	{
+		panels.append(create_panel());
+	}
+
+	const std::tuple<WidthProperty> table(WidthProperty{"panel.width"});
+
+	UndoStack undo_stack;
+	undo_stack.setMergeWindow(0);
+	undo_stack.setCountLimit(HISTORY_LIMIT);
+	undo_stack.setMemoryLimit(64 * 1024 * 1024);
+
+	float width = 1.0f;
+	run("snapshot.commit", size, size, [&] {
+		auto snapshot = binds::make_snapshot_scope(undo_stack, table, panels);
+		width += 1.0f;
+		for (const auto &panel : panels)
+		{
+			panel->setWidth(width);
+		}
+	});
+
+	run("snapshot.undo+redo", size, size, [&] {
+		undo_stack.undo();
+		undo_stack.redo();
+	});
+}
+
+// A table of num_rows panels with a page of widget rows, measures one row per op.
+// The cells are polled at the default refresh rate, so unchanged frames mostly
+// skip them.
+void bench_table(int num_rows)
+{
+	Unigine::Vector<PanelPtr> rows;
+	for (int i = 0; i < num_rows; ++i)
+	{
+		rows.append(create_panel());
+	}
+
+	UndoStack undo_stack;
+	binds::TableView<Panel> table(undo_stack, Unigine::GuiPtr(), rows);
+	table.addColumn<&Panel::getWidth, &Panel::setWidth>("width");
+	table.addColumn<&Panel::isEnabled, &Panel::setEnabled>("enabled");
+	table.update();
+
+	const int page = table.getNumVisibleRows();
+	run("table.update.rate-limited", num_rows, page, [&] { table.update(); });
+
+	// a page down per op, every widget row is pointed at another panel
+	run("table.scroll", num_rows, page, [&] {
+		const int first_row = table.getFirstRow() + page;
+		table.scrollTo(first_row < num_rows ? first_row : 0);
+		table.update();
+	});
+
+	// the caller reorders the rows on screen, the slots follow them
+	table.scrollTo(0);
+	run("table.reassign", num_rows, page, [&] {
+		for (int i = 0, j = std::min(page, num_rows) - 1; i < j; ++i, --j)
+		{
+			std::swap(rows[i], rows[j]);
+		}
+		table.update();
+	});
+
+	table.setRefreshRate(0.0f);
+	run("table.update.polled", num_rows, page, [&] { table.update(); });
+}
+
+} // namespace
+
+void *operator new(size_t size)
+{
+	num_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void *ptr = malloc(size ? size : 1))
+	{
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+// Kept out of line, GCC flags free() inlined into a delete of a pointer it saw
+// come from operator new as a mismatched deallocation.
+__attribute__((noinline)) void operator delete(void *ptr) noexcept
+{
+	free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void *ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+int main(int argc, char *argv[])
+{
+	// an optional upper bound for the number of bindings, e.g. 1000 for a quick run
+	const int max_bindings = argc > 1 ? atoi(argv[1]) : SIZES[sizeof(SIZES) / sizeof(SIZES[0]) - 1];
+
+	printf("%-32s %8s %12s %12s\n", "benchmark", "size", "ns/op", "allocs/op");
+
+	constexpr int SELECTION_SIZE = 8;
+	Unigine::Vector<PanelPtr> selection;
+	for (int i = 0; i < SELECTION_SIZE; ++i)
+	{
+		selection.append(create_panel());
+	}
+
+	for (const int size : SIZES)
+	{
+		if (size > max_bindings)
+		{
+			break;
+		}
+
+		Unigine::Vector<PanelPtr> single;
+		single.append(create_panel());
+		const PanelPtr &panel = single[0];
+
+		bench_update("single", binds::PtrInstance<Panel>(panel), single, size);
+		bench_update("selection", binds::PtrSelection<Panel>(selection), selection, size);
+		bench_set("single", binds::PtrInstance<Panel>(panel), size);
+		bench_set("selection", binds::PtrSelection<Panel>(selection), size);
+		bench_find(size);
+		bench_undo_stack(size);
+		bench_snapshot(size);
+		bench_table(size);
+	}
+
+	return 0;
+}
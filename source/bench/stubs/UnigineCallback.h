@@ -0,0 +1,35 @@
+#pragma once
+
+#include <utility>
+
+namespace Unigine
+{
+
+class CallbackBase
+{
+public:
+	virtual ~CallbackBase() = default;
+	virtual void run() = 0;
+};
+
+template<typename Func>
+class FunctorCallback final : public CallbackBase
+{
+public:
+	explicit FunctorCallback(Func func)
+		: func_(std::move(func))
+	{}
+
+	void run() override { func_(); }
+
+private:
+	Func func_;
+};
+
+template<typename Func>
+CallbackBase *MakeCallback(Func func)
+{
+	return new FunctorCallback<Func>(std::move(func));
+}
+
+} // namespace Unigine
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdio>
+
+namespace Unigine
+{
+
+class Log
+{
+public:
+	template<typename... Args>
+	static void message(const char *format, Args... args) { std::printf(format, args...); }
+
+	template<typename... Args>
+	static void warning(const char *format, Args... args) { std::fprintf(stderr, format, args...); }
+
+	template<typename... Args>
+	static void error(const char *format, Args... args) { std::fprintf(stderr, format, args...); }
+};
+
+} // namespace Unigine
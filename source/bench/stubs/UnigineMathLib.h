@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cmath>
+
+namespace Unigine
+{
+namespace Math
+{
+
+inline bool compare(float a, float b)
+{
+	return std::fabs(a - b) <= 1e-6f * (1.0f + std::fabs(a) + std::fabs(b));
+}
+
+inline bool compare(double a, double b)
+{
+	return std::fabs(a - b) <= 1e-9 * (1.0 + std::fabs(a) + std::fabs(b));
+}
+
+inline double lerp(double v0, double v1, double k) { return v0 + (v1 - v0) * k; }
+inline double inverseLerp(double v0, double v1, double v) { return (v - v0) / (v1 - v0); }
+
+template<typename T, int N>
+struct VecN
+{
+	T data[N]{};
+
+	T &operator[](int i) { return data[i]; }
+	T operator[](int i) const { return data[i]; }
+
+	bool operator==(const VecN &v) const
+	{
+		for (int i = 0; i < N; ++i)
+		{
+			if (data[i] != v.data[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	bool operator!=(const VecN &v) const { return !(*this == v); }
+
+	VecN operator+(const VecN &v) const
+	{
+		VecN ret;
+		for (int i = 0; i < N; ++i)
+		{
+			ret.data[i] = data[i] + v.data[i];
+		}
+		return ret;
+	}
+
+	VecN operator-(const VecN &v) const
+	{
+		VecN ret;
+		for (int i = 0; i < N; ++i)
+		{
+			ret.data[i] = data[i] - v.data[i];
+		}
+		return ret;
+	}
+};
+
+using vec2 = VecN<float, 2>;
+using vec3 = VecN<float, 3>;
+using vec4 = VecN<float, 4>;
+using dvec2 = VecN<double, 2>;
+using dvec3 = VecN<double, 3>;
+using dvec4 = VecN<double, 4>;
+using ivec2 = VecN<int, 2>;
+using ivec3 = VecN<int, 3>;
+using ivec4 = VecN<int, 4>;
+
+} // namespace Math
+} // namespace Unigine
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace Unigine
+{
+
+// Shared ownership like the engine's reference counted pointers.
+template<typename T>
+class Ptr
+{
+public:
+	Ptr() = default;
+	Ptr(std::nullptr_t) {}
+	explicit Ptr(std::shared_ptr<T> ptr)
+		: ptr_(std::move(ptr))
+	{}
+
+	template<typename U, typename = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+	Ptr(const Ptr<U> &other)
+		: ptr_(other.getShared())
+	{}
+
+	T *get() const { return ptr_.get(); }
+	T *operator->() const { return ptr_.get(); }
+	T &operator*() const { return *ptr_; }
+	explicit operator bool() const { return ptr_ != nullptr; }
+	bool isNull() const { return ptr_ == nullptr; }
+	bool isValid() const { return ptr_ != nullptr; }
+
+	bool operator==(const Ptr &other) const { return ptr_ == other.ptr_; }
+	bool operator!=(const Ptr &other) const { return ptr_ != other.ptr_; }
+
+	const std::shared_ptr<T> &getShared() const { return ptr_; }
+
+private:
+	std::shared_ptr<T> ptr_;
+};
+
+template<typename T, typename U>
+Ptr<T> checked_ptr_cast(const Ptr<U> &ptr)
+{
+	return Ptr<T>(std::dynamic_pointer_cast<T>(ptr.getShared()));
+}
+
+template<typename T, typename U>
+Ptr<T> static_ptr_cast(const Ptr<U> &ptr)
+{
+	return Ptr<T>(std::static_pointer_cast<T>(ptr.getShared()));
+}
+
+} // namespace Unigine
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstring>
+#include <string>
+
+namespace Unigine
+{
+
+class String
+{
+public:
+	String() = default;
+	String(const char *str)
+		: str_(str ? str : "")
+	{}
+
+	const char *get() const { return str_.c_str(); }
+	int size() const { return static_cast<int>(str_.size()); }
+	bool empty() const { return str_.empty(); }
+
+	bool operator==(const char *str) const { return str_ == (str ? str : ""); }
+	bool operator!=(const char *str) const { return !(*this == str); }
+
+private:
+	std::string str_;
+};
+
+} // namespace Unigine
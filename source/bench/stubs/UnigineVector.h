@@ -0,0 +1,164 @@
+#pragma once
+
+// Headless stand-ins for the few Unigine SDK types the bindings library uses,
+// just enough to build and benchmark it without the engine.
+
+#include <cassert>
+#include <type_traits>
+#include <utility>
+
+namespace Unigine
+{
+
+template<typename T>
+class Vector
+{
+public:
+	Vector() = default;
+	Vector(const Vector &other) { *this = other; }
+	Vector(Vector &&other) noexcept { swap(other); }
+	~Vector() { delete[] data_; }
+
+	Vector &operator=(const Vector &other)
+	{
+		if (this != &other)
+		{
+			clear();
+			reserve(other.size_);
+			for (int i = 0; i < other.size_; ++i)
+			{
+				data_[i] = other.data_[i];
+			}
+			size_ = other.size_;
+		}
+		return *this;
+	}
+
+	Vector &operator=(Vector &&other) noexcept
+	{
+		swap(other);
+		return *this;
+	}
+
+	int size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+
+	T &operator[](int i)
+	{
+		assert(i >= 0 && i < size_);
+		return data_[i];
+	}
+
+	const T &operator[](int i) const
+	{
+		assert(i >= 0 && i < size_);
+		return data_[i];
+	}
+
+	T &at(int i) { return (*this)[i]; }
+	const T &at(int i) const { return (*this)[i]; }
+
+	T &last() { return data_[size_ - 1]; }
+	const T &last() const { return data_[size_ - 1]; }
+
+	T *get() { return data_; }
+	const T *get() const { return data_; }
+
+	T *begin() { return data_; }
+	T *end() { return data_ + size_; }
+	const T *begin() const { return data_; }
+	const T *end() const { return data_ + size_; }
+
+	void append(const T &value)
+	{
+		if (size_ == capacity_)
+		{
+			T copy = value;
+			reserve(capacity_ ? capacity_ * 2 : 4);
+			data_[size_++] = std::move(copy);
+			return;
+		}
+		data_[size_++] = value;
+	}
+
+	void removeAt(int i)
+	{
+		assert(i >= 0 && i < size_);
+		for (int j = i + 1; j < size_; ++j)
+		{
+			data_[j - 1] = std::move(data_[j]);
+		}
+		data_[--size_] = T();
+	}
+
+	int findIndex(const T &value) const
+	{
+		for (int i = 0; i < size_; ++i)
+		{
+			if (data_[i] == value)
+			{
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	void reserve(int capacity)
+	{
+		if (capacity <= capacity_)
+		{
+			return;
+		}
+
+		T *data = new T[capacity];
+		for (int i = 0; i < size_ && i < capacity; ++i)
+		{
+			data[i] = std::move(data_[i]);
+		}
+		delete[] data_;
+		data_ = data;
+		capacity_ = capacity;
+	}
+
+	void resize(int size)
+	{
+		reserve(size);
+		for (int i = size; i < size_; ++i)
+		{
+			data_[i] = T();
+		}
+		size_ = size;
+	}
+
+	void clear() { resize(0); }
+
+	// releases the storage, pointers are deleted like the engine does
+	void destroy()
+	{
+		if constexpr (std::is_pointer_v<T>)
+		{
+			for (int i = 0; i < size_; ++i)
+			{
+				delete data_[i];
+			}
+		}
+		delete[] data_;
+		data_ = nullptr;
+		size_ = 0;
+		capacity_ = 0;
+	}
+
+	void swap(Vector &other) noexcept
+	{
+		std::swap(data_, other.data_);
+		std::swap(size_, other.size_);
+		std::swap(capacity_, other.capacity_);
+	}
+
+private:
+	T *data_{};
+	int size_{0};
+	int capacity_{0};
+};
+
+} // namespace Unigine
@@ -0,0 +1,294 @@
+#pragma once
+
+#include "UnigineCallback.h"
+#include "UniginePtr.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Unigine
+{
+
+class Gui
+{
+public:
+	enum
+	{
+		ALIGN_LEFT = 1 << 0,
+		ALIGN_TOP = 1 << 1,
+		ALIGN_EXPAND = 1 << 2,
+	};
+
+	enum
+	{
+		FOCUS_IN,
+		FOCUS_OUT,
+		PRESSED,
+		RELEASED,
+		CHANGED,
+		CLICKED,
+		NUM_CALLBACKS,
+	};
+};
+using GuiPtr = Ptr<Gui>;
+
+class Widget;
+using WidgetPtr = Ptr<Widget>;
+
+// Widgets keep their state only, callbacks run synchronously on the calling thread.
+class Widget
+{
+public:
+	virtual ~Widget() = default;
+
+	void *addCallback(int type, CallbackBase *callback)
+	{
+		callbacks_.push_back({type, std::unique_ptr<CallbackBase>(callback)});
+		return callback;
+	}
+
+	bool removeCallback(int type, void *id)
+	{
+		for (size_t i = 0; i < callbacks_.size(); ++i)
+		{
+			if (callbacks_[i].type == type && callbacks_[i].callback.get() == id)
+			{
+				callbacks_.erase(callbacks_.begin() + i);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void setCallbackEnabled(int type, bool enabled) { callbacks_enabled_[type] = enabled; }
+	bool isCallbackEnabled(int type) const { return callbacks_enabled_[type]; }
+
+	void runCallbacks(int type)
+	{
+		if (!callbacks_enabled_[type])
+		{
+			return;
+		}
+
+		for (const auto &callback : callbacks_)
+		{
+			if (callback.type == type)
+			{
+				callback.callback->run();
+			}
+		}
+	}
+
+	void addChild(const WidgetPtr &widget, int flags = 0)
+	{
+		children_.push_back(widget);
+		widget->parent_ = this;
+	}
+	void removeChild(const WidgetPtr &widget)
+	{
+		for (size_t i = 0; i < children_.size(); ++i)
+		{
+			if (children_[i] == widget)
+			{
+				children_.erase(children_.begin() + i);
+				widget->parent_ = nullptr;
+				return;
+			}
+		}
+	}
+	int getNumChildren() const { return static_cast<int>(children_.size()); }
+	WidgetPtr getChild(int num) const { return children_[num]; }
+	WidgetPtr getParent() const { return parent_ ? WidgetPtr(parent_->self_.lock()) : WidgetPtr(); }
+
+	void setHidden(bool hidden) { hidden_ = hidden; }
+	bool isHidden() const { return hidden_; }
+	bool isFocused() const { return focused_; }
+	void setFocus() { focused_ = true; }
+	void removeFocus() { focused_ = false; }
+
+	void setPosition(int x, int y)
+	{
+		x_ = x;
+		y_ = y;
+	}
+	int getScreenPositionX() const { return x_; }
+	int getScreenPositionY() const { return y_; }
+
+	void setWidth(int width) { width_ = width; }
+	void setHeight(int height) { height_ = height; }
+	int getWidth() const { return width_; }
+	int getHeight() const { return height_; }
+
+protected:
+	template<typename WidgetT>
+	static Ptr<WidgetT> make()
+	{
+		auto widget = std::make_shared<WidgetT>();
+		widget->self_ = widget;
+		return Ptr<WidgetT>(widget);
+	}
+
+private:
+	struct Callback
+	{
+		int type;
+		std::unique_ptr<CallbackBase> callback;
+	};
+
+	std::vector<Callback> callbacks_;
+	bool callbacks_enabled_[Gui::NUM_CALLBACKS]{true, true, true, true, true, true};
+
+	std::vector<WidgetPtr> children_;
+	Widget *parent_{};
+	std::weak_ptr<Widget> self_;
+
+	int x_{0};
+	int y_{0};
+	int width_{0};
+	int height_{0};
+	bool hidden_{false};
+	bool focused_{false};
+};
+
+class WidgetEditLine final : public Widget
+{
+public:
+	static Ptr<WidgetEditLine> create() { return make<WidgetEditLine>(); }
+	static Ptr<WidgetEditLine> create(const GuiPtr &, const char *) { return create(); }
+
+	void setText(const char *text)
+	{
+		text_ = text;
+		runCallbacks(Gui::CHANGED);
+	}
+	const char *getText() const { return text_.c_str(); }
+
+private:
+	std::string text_;
+};
+using WidgetEditLinePtr = Ptr<WidgetEditLine>;
+
+class WidgetSlider final : public Widget
+{
+public:
+	static Ptr<WidgetSlider> create() { return make<WidgetSlider>(); }
+
+	void setValue(int value)
+	{
+		value_ = value;
+		runCallbacks(Gui::CHANGED);
+	}
+	int getValue() const { return value_; }
+	int getMinValue() const { return 0; }
+	int getMaxValue() const { return 100; }
+
+private:
+	int value_{0};
+};
+using WidgetSliderPtr = Ptr<WidgetSlider>;
+
+class WidgetCheckBox final : public Widget
+{
+public:
+	static Ptr<WidgetCheckBox> create() { return make<WidgetCheckBox>(); }
+	static Ptr<WidgetCheckBox> create(const GuiPtr &, const char *) { return create(); }
+
+	void setChecked(bool checked)
+	{
+		checked_ = checked;
+		runCallbacks(Gui::CHANGED);
+	}
+	bool isChecked() const { return checked_; }
+
+private:
+	bool checked_{false};
+};
+using WidgetCheckBoxPtr = Ptr<WidgetCheckBox>;
+
+class WidgetComboBox final : public Widget
+{
+public:
+	static Ptr<WidgetComboBox> create() { return make<WidgetComboBox>(); }
+
+	int addItem(const char *str)
+	{
+		items_.push_back(str);
+		return static_cast<int>(items_.size()) - 1;
+	}
+	int getNumItems() const { return static_cast<int>(items_.size()); }
+
+	void setCurrentItem(int item)
+	{
+		item_ = item;
+		runCallbacks(Gui::CHANGED);
+	}
+	int getCurrentItem() const { return item_; }
+
+private:
+	std::vector<std::string> items_;
+	int item_{-1};
+};
+using WidgetComboBoxPtr = Ptr<WidgetComboBox>;
+
+class WidgetLabel final : public Widget
+{
+public:
+	static Ptr<WidgetLabel> create(const GuiPtr &, const char *text)
+	{
+		auto label = make<WidgetLabel>();
+		label->text_ = text;
+		return label;
+	}
+
+	void setText(const char *text) { text_ = text; }
+	const char *getText() const { return text_.c_str(); }
+
+private:
+	std::string text_;
+};
+using WidgetLabelPtr = Ptr<WidgetLabel>;
+
+// Layout boxes only group their children here.
+class WidgetVBox final : public Widget
+{
+public:
+	static Ptr<WidgetVBox> create(const GuiPtr &, int = 0, int = 0) { return make<WidgetVBox>(); }
+};
+using WidgetVBoxPtr = Ptr<WidgetVBox>;
+
+class WidgetHBox final : public Widget
+{
+public:
+	static Ptr<WidgetHBox> create(const GuiPtr &, int = 0, int = 0) { return make<WidgetHBox>(); }
+};
+using WidgetHBoxPtr = Ptr<WidgetHBox>;
+
+class WidgetScroll final : public Widget
+{
+public:
+	static Ptr<WidgetScroll> create(const GuiPtr &, int) { return make<WidgetScroll>(); }
+
+	void setObjectSize(int size) { object_size_ = size; }
+	int getObjectSize() const { return object_size_; }
+	void setFrameSize(int size) { frame_size_ = size; }
+	int getFrameSize() const { return frame_size_; }
+	void setStepSize(int size) { step_size_ = size; }
+	int getStepSize() const { return step_size_; }
+
+	void setValue(int value)
+	{
+		value_ = value;
+		runCallbacks(Gui::CHANGED);
+	}
+	int getValue() const { return value_; }
+
+private:
+	int object_size_{0};
+	int frame_size_{0};
+	int step_size_{1};
+	int value_{0};
+};
+using WidgetScrollPtr = Ptr<WidgetScroll>;
+
+} // namespace Unigine